@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AISchedulerSubsystem.h"
+#include "AIController.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/MemStack.h"
+#include "Enemy.h"
+#include "ScheduledBehaviorTreeComponent.h"
+#include "Shooter.h"
+#include "ShooterTimings.h"
+
+DECLARE_CYCLE_STAT(TEXT("AI Scheduler"), STAT_AIScheduler, STATGROUP_Shooter);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("AI ms"), STAT_AIMs, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Trees Ticked"), STAT_AITreesTicked, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Trees Deferred"), STAT_AITreesDeferred, STATGROUP_Shooter);
+
+UAISchedulerSubsystem::UAISchedulerSubsystem() :
+	BudgetMs(2.f),
+	NearDistance(1500.f),
+	FarDistance(5000.f),
+	NearTickRate(5.f),
+	FarTickRate(2.f),
+	LastFrameMs(0.f)
+{
+}
+
+void UAISchedulerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_AIScheduler);
+	SHOOTER_SCOPE_TIMING(AI);
+
+	Trees.RemoveAll([](const TWeakObjectPtr<UScheduledBehaviorTreeComponent>& Tree) { return !Tree.IsValid(); });
+	if (Trees.Num() == 0) return;
+
+	const double StartTime{ FPlatformTime::Seconds() };
+	const float Now{ GetWorld()->GetTimeSeconds() };
+	const APawn* Player{ UGameplayStatics::GetPlayerPawn(this, 0) };
+	const FVector PlayerLocation{ Player ? Player->GetActorLocation() : FVector::ZeroVector };
+
+	// ticking a tree can spawn or destroy enemies, which registers and unregisters trees under us
+	FMemMark Mark(FMemStack::Get());
+	const TArray<TWeakObjectPtr<UScheduledBehaviorTreeComponent>, TMemStackAllocator<>> Snapshot(Trees);
+
+	// trees that are due but not in melee, with how overdue they are
+	using FDueTree = TPair<float, TWeakObjectPtr<UScheduledBehaviorTreeComponent>>;
+	TArray<FDueTree, TMemStackAllocator<>> Due;
+	int32 NumTicked{ 0 };
+
+	for (const TWeakObjectPtr<UScheduledBehaviorTreeComponent>& WeakTree : Snapshot)
+	{
+		UScheduledBehaviorTreeComponent* Tree{ WeakTree.Get() };
+		if (Tree == nullptr) continue;
+
+		const AAIController* Controller{ Cast<AAIController>(Tree->GetOwner()) };
+		const APawn* Pawn{ Controller ? Controller->GetPawn() : nullptr };
+		const AEnemy* Enemy{ Cast<AEnemy>(Pawn) };
+		if (!Tree->WantsTick() || Tree->IsPaused() || (Enemy && Enemy->IsDormant()))
+		{
+			// nothing to catch up on when it starts again
+			Tree->SetLastScheduledTime(Now);
+			continue;
+		}
+
+		if (Enemy && Enemy->IsInAttackRange())
+		{
+			Tree->ScheduledTick(Now);
+			NumTicked++;
+			continue;
+		}
+
+		const float Distance{ Pawn && Player ? FVector::Dist(Pawn->GetActorLocation(), PlayerLocation) : FarDistance };
+		const float Interval{ GetTickInterval(Distance) };
+		const float SinceLastTick{ Now - Tree->GetLastScheduledTime() };
+		if (SinceLastTick >= Interval)
+		{
+			// every frame trees are as overdue as a frame is long
+			Due.Emplace(SinceLastTick / FMath::Max(Interval, DeltaTime), WeakTree);
+		}
+	}
+
+	Due.Sort([](const FDueTree& A, const FDueTree& B) { return A.Key > B.Key; });
+
+	// the budget only covers these, melee ticks above must not starve them
+	const double BudgetStartTime{ FPlatformTime::Seconds() };
+	int32 NumDeferred{ 0 };
+	for (int32 i = 0; i < Due.Num(); i++)
+	{
+		if (i > 0 && (FPlatformTime::Seconds() - BudgetStartTime) * 1000.0 >= BudgetMs)
+		{
+			NumDeferred = Due.Num() - i;
+			break;
+		}
+		if (UScheduledBehaviorTreeComponent* Tree = Due[i].Value.Get())
+		{
+			Tree->ScheduledTick(Now);
+			NumTicked++;
+		}
+	}
+
+	LastFrameMs = static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	SET_FLOAT_STAT(STAT_AIMs, LastFrameMs);
+	SET_DWORD_STAT(STAT_AITreesTicked, NumTicked);
+	SET_DWORD_STAT(STAT_AITreesDeferred, NumDeferred);
+}
+
+TStatId UAISchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAISchedulerSubsystem, STATGROUP_Tickables);
+}
+
+bool UAISchedulerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UAISchedulerSubsystem::Register(UScheduledBehaviorTreeComponent* Tree)
+{
+	if (Tree == nullptr) return;
+
+	Tree->SetLastScheduledTime(GetWorld()->GetTimeSeconds());
+	Trees.AddUnique(Tree);
+}
+
+void UAISchedulerSubsystem::Unregister(UScheduledBehaviorTreeComponent* Tree)
+{
+	Trees.Remove(Tree);
+}
+
+float UAISchedulerSubsystem::GetTickInterval(float Distance) const
+{
+	if (Distance <= NearDistance) return 0.f;
+
+	const float Alpha{ FMath::GetRangePct(NearDistance, FMath::Max(FarDistance, NearDistance + 1.f), FMath::Min(Distance, FarDistance)) };
+	const float Rate{ FMath::Lerp(NearTickRate, FarTickRate, Alpha) };
+	return Rate > 0.f ? 1.f / Rate : 0.f;
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AISchedulerSubsystem.generated.h"
+
+class UScheduledBehaviorTreeComponent;
+
+/**
+ * Ticks every enemy's behavior tree from one place within a per frame time budget.
+ * Enemies in attack range tick every frame, the rest tick at a rate that falls with distance
+ * to the player. Trees that are due are ticked most overdue first until the budget runs out,
+ * whatever is left over is more overdue next frame. The most overdue tree always ticks, so
+ * a crowd in attack range can't starve the rest.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UAISchedulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UAISchedulerSubsystem();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	void Register(UScheduledBehaviorTreeComponent* Tree);
+	void Unregister(UScheduledBehaviorTreeComponent* Tree);
+
+	// Game thread time spent in behavior trees last frame
+	FORCEINLINE float GetLastFrameMs() const { return LastFrameMs; }
+
+private:
+
+	// Seconds between ticks for a tree this far from the player, 0 for every frame
+	float GetTickInterval(float Distance) const;
+
+	// Milliseconds of distance scheduled behavior tree ticks per frame, trees in attack range tick on top
+	UPROPERTY(Config)
+	float BudgetMs;
+
+	// Closer than this ticks every frame
+	UPROPERTY(Config)
+	float NearDistance;
+
+	// Further than this ticks at FarTickRate
+	UPROPERTY(Config)
+	float FarDistance;
+
+	// Ticks per second just outside NearDistance
+	UPROPERTY(Config)
+	float NearTickRate;
+
+	// Ticks per second from FarDistance on
+	UPROPERTY(Config)
+	float FarTickRate;
+
+	TArray<TWeakObjectPtr<UScheduledBehaviorTreeComponent>> Trees;
+
+	float LastFrameMs;
+};
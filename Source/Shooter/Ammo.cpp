@@ -3,9 +3,9 @@
 
 #include "Ammo.h"
 #include "Components/BoxComponent.h"
-#include "Components/WidgetComponent.h"
 #include "Components/SphereComponent.h"
 #include "ShooterCharacter.h"
+#include "ItemCollisionProfile.h"
 
 
 AAmmo::AAmmo() // CONSTRUCTOR
@@ -15,7 +15,6 @@ AAmmo::AAmmo() // CONSTRUCTOR
 	SetRootComponent(AmmoMesh);
 
 	GetCollisionBox()->SetupAttachment(GetRootComponent());
-	GetPickupWidget()->SetupAttachment(GetRootComponent());
 	GetAreaSphere()->SetupAttachment(GetRootComponent());
 
 	AmmoCollisionSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AmmoCollisionSphere"));
@@ -39,43 +38,13 @@ void AAmmo::SetItemProperties(EItemState State)
 {
 	Super::SetItemProperties(State);
 
-	switch (State)
+	// the ammo mesh behaves like the item mesh
+	ItemCollisionProfile::Apply(AmmoMesh, ItemCollisionProfile::Get(State, EItemComponent::Mesh));
+
+	if (State == EItemState::EIS_Pickup)
 	{
-	case EItemState::EIS_Pickup:
-		// Set Mesh properties
-		AmmoMesh->SetSimulatePhysics(false);
-		AmmoMesh->SetEnableGravity(false);
-		AmmoMesh->SetVisibility(true);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-
-	case EItemState::EIS_Equipped:
-		// Set Mesh properties
-		AmmoMesh->SetSimulatePhysics(false);
-		AmmoMesh->SetEnableGravity(false);
-		AmmoMesh->SetVisibility(true);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-
-	case EItemState::EIS_Falling:
-		// Set mesh properties
-		AmmoMesh->SetSimulatePhysics(true);
-		AmmoMesh->SetEnableGravity(true);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AmmoMesh->SetCollisionResponseToChannel(ECollisionChannel::ECC_WorldStatic, ECollisionResponse::ECR_Block);
-		break;
-
-	case EItemState::EIS_EquipInterping:
-		// Set Mesh properties
-		AmmoMesh->SetSimulatePhysics(false);
-		AmmoMesh->SetEnableGravity(false);
-		AmmoMesh->SetVisibility(true);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
+		// Set ammo collision sphere properties, may have been turned off while asleep
+		AmmoCollisionSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
 	}
 }
 
@@ -92,6 +61,12 @@ void AAmmo::AmmoSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor*
 	}
 }
 
+void AAmmo::DisableOverlaps()
+{
+	Super::DisableOverlaps();
+	AmmoCollisionSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
 void AAmmo::EnableCustomDepth()
 {
 	AmmoMesh->SetRenderCustomDepth(true);
@@ -27,6 +27,8 @@ protected:
 	// override of set item properties so we can set ammo mesh properties
 	virtual void SetItemProperties(EItemState State) override;
 
+	virtual void DisableOverlaps() override;
+
 	UFUNCTION()
 	void AmmoSphereOverlap(
 			UPrimitiveComponent* OverlappedComponent,
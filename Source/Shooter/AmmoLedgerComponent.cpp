@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AmmoLedgerComponent.h"
+
+static_assert(static_cast<int32>(EAmmoType::EAT_MAX) <= 64, "DirtyTypes has one bit per ammo type");
+
+UAmmoLedgerComponent::UAmmoLedgerComponent() :
+	DirtyTypes(0)
+{
+	bWantsInitializeComponent = true;
+
+	// only ticks on frames with something to broadcast
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+	StartingAmmo.Add(EAmmoType::EAT_9mm, 85);
+	StartingAmmo.Add(EAmmoType::EAT_AR, 50);
+}
+
+void UAmmoLedgerComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	const int32 NumTypes{ static_cast<int32>(EAmmoType::EAT_MAX) };
+	Counts.Init(0, NumTypes);
+	Caps.Init(0, NumTypes);
+	for (const TPair<EAmmoType, int32>& Cap : MaxAmmo)
+	{
+		if (Cap.Key < EAmmoType::EAT_MAX)
+		{
+			Caps[static_cast<int32>(Cap.Key)] = FMath::Max(Cap.Value, 0);
+		}
+	}
+	for (const TPair<EAmmoType, int32>& Start : StartingAmmo)
+	{
+		AddAmmo(Start.Key, Start.Value);
+	}
+}
+
+void UAmmoLedgerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SetComponentTickEnabled(false);
+
+	uint64 Dirty{ DirtyTypes };
+	DirtyTypes = 0;
+	while (Dirty != 0)
+	{
+		const int32 Index{ static_cast<int32>(FMath::CountTrailingZeros64(Dirty)) };
+		Dirty &= Dirty - 1;
+		AmmoChangedDelegate.Broadcast(static_cast<EAmmoType>(Index), Counts[Index]);
+	}
+}
+
+int32 UAmmoLedgerComponent::GetAmmo(EAmmoType AmmoType) const
+{
+	const int32 Index{ static_cast<int32>(AmmoType) };
+	return Counts.IsValidIndex(Index) ? Counts[Index] : 0;
+}
+
+int32 UAmmoLedgerComponent::GetMaxAmmo(EAmmoType AmmoType) const
+{
+	const int32 Index{ static_cast<int32>(AmmoType) };
+	return Caps.IsValidIndex(Index) ? Caps[Index] : 0;
+}
+
+int32 UAmmoLedgerComponent::AddAmmo(EAmmoType AmmoType, int32 Amount)
+{
+	const int32 Index{ static_cast<int32>(AmmoType) };
+	if (!Counts.IsValidIndex(Index) || Amount <= 0) return 0;
+
+	const int32 Room{ Caps[Index] > 0 ? Caps[Index] - Counts[Index] : MAX_int32 - Counts[Index] };
+	const int32 Added{ FMath::Clamp(Amount, 0, Room) };
+	if (Added > 0)
+	{
+		Counts[Index] += Added;
+		MarkDirty(Index);
+	}
+	return Added;
+}
+
+int32 UAmmoLedgerComponent::TakeAmmo(EAmmoType AmmoType, int32 Amount)
+{
+	const int32 Index{ static_cast<int32>(AmmoType) };
+	if (!Counts.IsValidIndex(Index) || Amount <= 0) return 0;
+
+	const int32 Taken{ FMath::Min(Amount, Counts[Index]) };
+	if (Taken > 0)
+	{
+		Counts[Index] -= Taken;
+		MarkDirty(Index);
+	}
+	return Taken;
+}
+
+void UAmmoLedgerComponent::MarkDirty(int32 Index)
+{
+	DirtyTypes |= 1ull << Index;
+	SetComponentTickEnabled(true);
+}
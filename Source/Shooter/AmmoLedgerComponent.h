@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "AmmoType.h"
+#include "AmmoLedgerComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FAmmoChangedDelegate, EAmmoType, AmmoType, int32, NewCount);
+
+/**
+ * Carried ammo, one count per EAmmoType in a flat array.
+ * Starting amounts and caps are authored as maps but flattened once at initialization,
+ * and changes are broadcast at most once per type per frame.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SHOOTER_API UAmmoLedgerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UAmmoLedgerComponent();
+
+	virtual void InitializeComponent() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	UFUNCTION(BlueprintPure, Category = Ammo)
+	int32 GetAmmo(EAmmoType AmmoType) const;
+
+	// Most ammo of a type that can be carried, 0 for no cap
+	UFUNCTION(BlueprintPure, Category = Ammo)
+	int32 GetMaxAmmo(EAmmoType AmmoType) const;
+
+	UFUNCTION(BlueprintPure, Category = Ammo)
+	bool HasAmmo(EAmmoType AmmoType) const { return GetAmmo(AmmoType) > 0; }
+
+	// Add up to the cap, returns how much was added
+	int32 AddAmmo(EAmmoType AmmoType, int32 Amount);
+
+	// Remove up to Amount, returns how much was removed
+	int32 TakeAmmo(EAmmoType AmmoType, int32 Amount);
+
+	// Change the authored starting amount, only has an effect before the component initializes
+	FORCEINLINE void SetStartingAmmo(EAmmoType AmmoType, int32 Amount) { StartingAmmo.Add(AmmoType, Amount); }
+
+	// Broadcast at most once per type per frame
+	UPROPERTY(BlueprintAssignable, Category = Delegate)
+	FAmmoChangedDelegate AmmoChangedDelegate;
+
+private:
+
+	void MarkDirty(int32 Index);
+
+	// Ammo carried when the game starts
+	UPROPERTY(EditDefaultsOnly, Category = Ammo, meta = (AllowPrivateAccess = "true"))
+	TMap<EAmmoType, int32> StartingAmmo;
+
+	// Cap per ammo type, types left out are uncapped
+	UPROPERTY(EditDefaultsOnly, Category = Ammo, meta = (AllowPrivateAccess = "true"))
+	TMap<EAmmoType, int32> MaxAmmo;
+
+	// indexed by EAmmoType
+	TArray<int32, TInlineAllocator<static_cast<int32>(EAmmoType::EAT_MAX)>> Counts;
+	TArray<int32, TInlineAllocator<static_cast<int32>(EAmmoType::EAT_MAX)>> Caps;
+
+	// bit per ammo type changed since the last broadcast
+	uint64 DirtyTypes;
+};
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BakedCurve.h"
+#include "Curves/CurveFloat.h"
+#include "Curves/CurveVector.h"
+
+namespace
+{
+	// Fill in the sampling parameters for a key range, returns the time between samples
+	float SetupSampling(float MinTime, float MaxTime, int32 NumSamples, float& OutSamplesPerSecond)
+	{
+		const float Duration{ MaxTime - MinTime };
+		OutSamplesPerSecond = Duration > KINDA_SMALL_NUMBER ? (NumSamples - 1) / Duration : 0.f;
+		return Duration / (NumSamples - 1);
+	}
+}
+
+void FBakedCurve::Bake(const UCurveFloat* Curve, int32 NumSamples)
+{
+	NumSamples = FMath::Max(NumSamples, 2);
+
+	float MaxTime{ 0.f };
+	Curve->GetTimeRange(MinTime, MaxTime);
+	const float Step{ SetupSampling(MinTime, MaxTime, NumSamples, SamplesPerSecond) };
+	LastSample = static_cast<float>(NumSamples - 1);
+
+	Samples.SetNumUninitialized(NumSamples);
+	for (int32 i = 0; i < NumSamples; i++)
+	{
+		Samples[i] = Curve->GetFloatValue(MinTime + Step * i);
+	}
+}
+
+void FBakedCurve::EvaluateBatch(TArrayView<const float> Times, TArrayView<float> OutValues) const
+{
+	check(Times.Num() == OutValues.Num());
+	for (int32 i = 0; i < Times.Num(); i++)
+	{
+		OutValues[i] = Evaluate(Times[i]);
+	}
+}
+
+void FBakedVectorCurve::Bake(const UCurveVector* Curve, int32 NumSamples)
+{
+	NumSamples = FMath::Max(NumSamples, 2);
+
+	float MaxTime{ 0.f };
+	Curve->GetTimeRange(MinTime, MaxTime);
+	const float Step{ SetupSampling(MinTime, MaxTime, NumSamples, SamplesPerSecond) };
+	LastSample = static_cast<float>(NumSamples - 1);
+
+	Samples.SetNumUninitialized(NumSamples);
+	for (int32 i = 0; i < NumSamples; i++)
+	{
+		Samples[i] = FVector3f(Curve->GetVectorValue(MinTime + Step * i));
+	}
+}
+
+void FBakedVectorCurve::EvaluateBatch(TArrayView<const float> Times, TArrayView<FVector> OutValues) const
+{
+	check(Times.Num() == OutValues.Num());
+	for (int32 i = 0; i < Times.Num(); i++)
+	{
+		OutValues[i] = Evaluate(Times[i]);
+	}
+}
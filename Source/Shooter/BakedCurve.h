@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UCurveFloat;
+class UCurveVector;
+
+// A float curve sampled at a fixed rate over its key range, evaluated with one lerp
+struct SHOOTER_API FBakedCurve
+{
+	void Bake(const UCurveFloat* Curve, int32 NumSamples);
+
+	FORCEINLINE float Evaluate(float Time) const
+	{
+		// times outside the key range clamp to the end samples, like the curve's constant extrapolation
+		const float Position{ FMath::Clamp((Time - MinTime) * SamplesPerSecond, 0.f, LastSample) };
+		const int32 Index{ FMath::Min(static_cast<int32>(Position), Samples.Num() - 2) };
+		return FMath::Lerp(Samples[Index], Samples[Index + 1], Position - Index);
+	}
+
+	// Evaluate many times at once, OutValues must be as long as Times
+	void EvaluateBatch(TArrayView<const float> Times, TArrayView<float> OutValues) const;
+
+private:
+	float MinTime{ 0.f };
+	float SamplesPerSecond{ 0.f };
+	float LastSample{ 0.f };
+
+	// always at least two samples
+	TArray<float> Samples;
+};
+
+// A vector curve sampled at a fixed rate over its key range, evaluated with one lerp
+struct SHOOTER_API FBakedVectorCurve
+{
+	void Bake(const UCurveVector* Curve, int32 NumSamples);
+
+	FORCEINLINE FVector Evaluate(float Time) const
+	{
+		const float Position{ FMath::Clamp((Time - MinTime) * SamplesPerSecond, 0.f, LastSample) };
+		const int32 Index{ FMath::Min(static_cast<int32>(Position), Samples.Num() - 2) };
+		return FVector(FMath::Lerp(Samples[Index], Samples[Index + 1], Position - Index));
+	}
+
+	// Evaluate many times at once, OutValues must be as long as Times
+	void EvaluateBatch(TArrayView<const float> Times, TArrayView<FVector> OutValues) const;
+
+private:
+	float MinTime{ 0.f };
+	float SamplesPerSecond{ 0.f };
+	float LastSample{ 0.f };
+
+	// always at least two samples
+	TArray<FVector3f> Samples;
+};
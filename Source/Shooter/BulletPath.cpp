@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BulletPath.h"
+#include "Engine/World.h"
+#include "Components/PrimitiveComponent.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "Shooter.h"
+#include "TraceSchedulerSubsystem.h"
+
+FBulletTracer::FBulletTracer() :
+	MaxSegments(4),
+	MinDamageMultiplier(0.1f)
+{
+	Initialize(nullptr);
+}
+
+void FBulletTracer::Initialize(const UDataTable* SurfaceTable)
+{
+	// anything without an entry (flesh, wood, ...) can be shot through if thin enough
+	for (int32 i = 0; i < SurfaceType_Max; i++)
+	{
+		Surfaces[i].SurfaceType = static_cast<EPhysicalSurface>(i);
+		Surfaces[i].MaxPenetrationDepth = 15.f;
+		Surfaces[i].PenetrationDamageMultiplier = 0.6f;
+		Surfaces[i].RicochetAngle = 0.f;
+		Surfaces[i].RicochetDamageMultiplier = 0.5f;
+	}
+
+	auto SetSurface = [this](EPhysicalSurface Surface, float Depth, float PenetrationMultiplier, float RicochetAngle, float RicochetMultiplier)
+	{
+		FSurfacePenetrationTable& Row{ Surfaces[Surface] };
+		Row.MaxPenetrationDepth = Depth;
+		Row.PenetrationDamageMultiplier = PenetrationMultiplier;
+		Row.RicochetAngle = RicochetAngle;
+		Row.RicochetDamageMultiplier = RicochetMultiplier;
+	};
+	SetSurface(EPS_Metal, 2.f, 0.4f, 25.f, 0.6f);
+	SetSurface(EPS_Stone, 8.f, 0.3f, 15.f, 0.5f);
+	SetSurface(EPS_Tile, 5.f, 0.5f, 10.f, 0.5f);
+	SetSurface(EPS_Grass, 200.f, 0.9f, 0.f, 0.5f);
+	SetSurface(EPS_Water, 100.f, 0.2f, 8.f, 0.7f);
+
+	if (SurfaceTable)
+	{
+		SurfaceTable->ForeachRow<FSurfacePenetrationTable>(TEXT("FBulletTracer::Initialize"),
+			[this](const FName& Key, const FSurfacePenetrationTable& Row)
+			{
+				Surfaces[Row.SurfaceType] = Row;
+			});
+	}
+}
+
+bool FBulletTracer::TracePath(
+	const UWorld* World,
+	const FVector& Start,
+	const FVector& Direction,
+	float Range,
+	const AActor* IgnoredActor,
+	FBulletPath& OutPath) const
+{
+	OutPath.Impacts.Reset();
+	OutPath.Points.Reset();
+	OutPath.Points.Add(Start);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BulletPath), false, IgnoredActor);
+	QueryParams.bReturnPhysicalMaterial = true;
+
+	FVector SegmentStart{ Start };
+	FVector SegmentDirection{ Direction.GetSafeNormal() };
+	float RemainingRange{ Range };
+	float DamageMultiplier{ 1.f };
+	bool bBlockingHit{ false };
+	int32 NumTraces{ 0 };
+
+	const int32 NumSegments{ FMath::Clamp(MaxSegments, 1, MAX_BULLET_SEGMENTS) };
+	for (int32 Segment = 0; Segment < NumSegments && RemainingRange > 0.f; Segment++)
+	{
+		// one query per segment for the first blocking hit, overlaps like an enemy's agro sphere aren't impacts
+		const FVector SegmentEnd{ SegmentStart + SegmentDirection * RemainingRange };
+		FHitResult Hit;
+		World->LineTraceSingleByChannel(
+			Hit,
+			SegmentStart,
+			SegmentEnd,
+			ECollisionChannel::ECC_Visibility,
+			QueryParams);
+		NumTraces++;
+
+		if (!Hit.bBlockingHit)
+		{
+			// nothing in the way, bullet flies out of range
+			OutPath.Points.Add(SegmentEnd);
+			break;
+		}
+
+		bBlockingHit = true;
+		OutPath.Impacts.Add({ Hit, DamageMultiplier });
+		OutPath.Points.Add(Hit.ImpactPoint);
+		RemainingRange -= Hit.Distance;
+
+		const FSurfacePenetrationTable& Surface{ Surfaces[UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get())] };
+
+		// angle between the bullet and the surface plane, 0 is a perfect graze
+		const float CosToNormal{ FMath::Clamp(FVector::DotProduct(-SegmentDirection, Hit.ImpactNormal), -1.f, 1.f) };
+		const float GrazingAngle{ 90.f - FMath::RadiansToDegrees(FMath::Acos(CosToNormal)) };
+
+		if (GrazingAngle < Surface.RicochetAngle)
+		{
+			// bounce off the surface
+			SegmentDirection = SegmentDirection.MirrorByVector(Hit.ImpactNormal);
+			SegmentStart = Hit.ImpactPoint + Hit.ImpactNormal;
+			DamageMultiplier *= Surface.RicochetDamageMultiplier;
+		}
+		else
+		{
+			const float Thickness{ MeasureThickness(Hit, SegmentDirection, Surface.MaxPenetrationDepth) };
+			NumTraces++;
+			if (Thickness < 0.f)
+			{
+				// too thick, the bullet stops here
+				break;
+			}
+
+			// lose damage in proportion to how much of the max depth we went through
+			DamageMultiplier *= FMath::Lerp(1.f, Surface.PenetrationDamageMultiplier, Thickness / Surface.MaxPenetrationDepth);
+			SegmentStart = Hit.ImpactPoint + SegmentDirection * (Thickness + 1.f);
+			RemainingRange -= Thickness;
+			QueryParams.AddIgnoredComponent(Hit.GetComponent());
+		}
+
+		if (DamageMultiplier < MinDamageMultiplier)
+		{
+			break;
+		}
+	}
+
+	UTraceSchedulerSubsystem::AddTraces(World, ETraceCategory::Combat, NumTraces);
+	return bBlockingHit;
+}
+
+float FBulletTracer::MeasureThickness(const FHitResult& HitResult, const FVector& Direction, float MaxDepth)
+{
+	UPrimitiveComponent* Component{ HitResult.GetComponent() };
+	if (Component == nullptr || MaxDepth <= 0.f) return -1.f;
+
+	// trace back from the deepest point the bullet could reach, the first hit is the exit
+	const FVector DeepestPoint{ HitResult.ImpactPoint + Direction * MaxDepth };
+	FHitResult ExitHit;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BulletExit), false);
+	if (!Component->LineTraceComponent(ExitHit, DeepestPoint, HitResult.ImpactPoint, QueryParams) || ExitHit.bStartPenetrating)
+	{
+		// deepest point is still inside the component
+		return -1.f;
+	}
+	return FVector::Dist(HitResult.ImpactPoint, ExitHit.ImpactPoint);
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Chaos/ChaosEngineInterface.h"
+#include "BulletPath.generated.h"
+
+// Hard cap on segments a single shot can be split into by penetrations and ricochets
+static constexpr int32 MAX_BULLET_SEGMENTS{ 8 };
+
+USTRUCT(BlueprintType)
+struct FSurfacePenetrationTable : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TEnumAsByte<EPhysicalSurface> SurfaceType = EPhysicalSurface::SurfaceType_Default;
+
+	// thickest piece of this material a bullet can pass through
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxPenetrationDepth = 0.f;
+
+	// fraction of damage kept after passing through MaxPenetrationDepth of this material
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float PenetrationDamageMultiplier = 0.5f;
+
+	// bullets hitting at a grazing angle below this (degrees) bounce off
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float RicochetAngle = 0.f;
+
+	// fraction of damage kept after a ricochet
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float RicochetDamageMultiplier = 0.5f;
+};
+
+// A hit along the path of a bullet, and how much damage the bullet still carries there
+struct FBulletImpact
+{
+	FHitResult HitResult;
+	float DamageMultiplier{ 1.f };
+};
+
+// Result of tracing one shot. Inline storage, a shot never touches the heap
+struct FBulletPath
+{
+	// every blocking surface hit by the bullet, in order, at most one per segment
+	TArray<FBulletImpact, TInlineAllocator<MAX_BULLET_SEGMENTS>> Impacts;
+
+	// polyline of the bullet's flight: muzzle, each blocking impact, then where it stopped
+	TArray<FVector, TInlineAllocator<MAX_BULLET_SEGMENTS + 1>> Points;
+};
+
+/**
+ * Follows a shot through penetrable surfaces and ricochets.
+ * Each segment is resolved with one single line trace; per surface properties are
+ * looked up from a flat table indexed by EPhysicalSurface.
+ */
+struct FBulletTracer
+{
+	FBulletTracer();
+
+	// Fill the surface lookup from a penetration data table, or built-in defaults when null
+	void Initialize(const class UDataTable* SurfaceTable);
+
+	// Trace a shot of length Range from Start along Direction.
+	// Returns true if the bullet hit anything blocking
+	bool TracePath(
+		const UWorld* World,
+		const FVector& Start,
+		const FVector& Direction,
+		float Range,
+		const AActor* IgnoredActor,
+		FBulletPath& OutPath) const;
+
+	// segments traced per shot, clamped to MAX_BULLET_SEGMENTS
+	int32 MaxSegments;
+
+	// bullet stops once its damage falls below this fraction
+	float MinDamageMultiplier;
+
+private:
+
+	// How far the bullet travels inside HitResult's component along Direction, or -1 if it doesn't exit within MaxDepth
+	static float MeasureThickness(const FHitResult& HitResult, const FVector& Direction, float MaxDepth);
+
+	FSurfacePenetrationTable Surfaces[SurfaceType_Max];
+};
@@ -0,0 +1,215 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Camera/CameraComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameMapsSettings.h"
+#include "Explosive.h"
+#include "ShooterCharacter.h"
+#include "Weapon.h"
+
+namespace
+{
+	// Forwards to the real allocator and counts the allocations made on the game thread while counting
+	class FAllocationCounter : public FMalloc
+	{
+	public:
+		explicit FAllocationCounter(FMalloc* InInner) :
+			Inner(InInner),
+			NumAllocations(0),
+			bCounting(false)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			// a realloc to zero is a free
+			if (Count > 0)
+			{
+				CountAllocation();
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+		FORCEINLINE int32 GetNumAllocations() const { return NumAllocations; }
+
+		FORCEINLINE void StartCounting()
+		{
+			NumAllocations = 0;
+			bCounting = true;
+		}
+
+		FORCEINLINE void StopCounting() { bCounting = false; }
+
+		// Installed on first use and never taken out again. A call another thread is making on the
+		// old allocator finishes there, and whatever it frees later reaches the same allocator through us
+		static FAllocationCounter& Get()
+		{
+			static FAllocationCounter* Counter{ [] ()
+			{
+				FAllocationCounter* NewCounter{ new FAllocationCounter(GMalloc) };
+				GMalloc = NewCounter;
+				return NewCounter;
+			}() };
+			return *Counter;
+		}
+
+	private:
+
+		// other threads keep allocating, only the game thread runs the combat loop
+		FORCEINLINE void CountAllocation()
+		{
+			if (bCounting && IsInGameThread())
+			{
+				NumAllocations++;
+			}
+		}
+
+		FMalloc* Inner;
+		int32 NumAllocations;
+		bool bCounting;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCombatAllocationTest,
+	"Shooter.Performance.SteadyStateCombatAllocations",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FCombatAllocationTest::RunTest(const FString& Parameters)
+{
+#if PLATFORM_USES_FIXED_GMalloc_CLASS
+	// FMemory calls the platform allocator directly, a proxy in GMalloc would never see an allocation
+	AddWarning(TEXT("GMalloc is fixed on this platform, allocations can't be counted"));
+	return true;
+#else
+	constexpr float DeltaTime{ 1.f / 60.f };
+	constexpr int32 NumWarmupFrames{ 120 };
+	constexpr int32 NumMeasuredFrames{ 120 };
+	constexpr float TargetDistance{ 1000.f };
+
+	// the project's player character, it carries the weapon, effects and sounds the loop exercises
+	const UClass* GameModeClass{ LoadClass<AGameModeBase>(nullptr, *UGameMapsSettings::GetGlobalDefaultGameMode()) };
+	UClass* CharacterClass{ GameModeClass ? GetDefault<AGameModeBase>(const_cast<UClass*>(GameModeClass))->DefaultPawnClass.Get() : nullptr };
+	if (CharacterClass == nullptr || !CharacterClass->IsChildOf<AShooterCharacter>())
+	{
+		AddWarning(TEXT("The default game mode's pawn isn't a shooter character, there's nothing to fire"));
+		return true;
+	}
+
+	UStaticMesh* Cube{ LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")) };
+	if (!TestNotNull(TEXT("Cube mesh"), Cube))
+	{
+		return false;
+	}
+
+	FAllocationCounter& Counter{ FAllocationCounter::Get() };
+
+	UWorld* World{ UWorld::CreateWorld(EWorldType::Game, false) };
+	FWorldContext& WorldContext{ GEngine->CreateNewWorldContext(EWorldType::Game) };
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	auto DestroyWorld = [World]()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	};
+
+	// something to stand on
+	AStaticMeshActor* Floor{ World->SpawnActor<AStaticMeshActor>(FVector(0.f, 0.f, -50.f), FRotator::ZeroRotator) };
+	Floor->GetStaticMeshComponent()->SetStaticMesh(Cube);
+	Floor->SetActorScale3D(FVector(100.f, 100.f, 1.f));
+
+	AShooterCharacter* Character{ World->SpawnActor<AShooterCharacter>(CharacterClass, FVector(0.f, 0.f, 100.f), FRotator::ZeroRotator) };
+	AWeapon* Weapon{ Character ? Character->GetEquippedWeapon() : nullptr };
+	if (!TestNotNull(TEXT("Character"), Character) || !TestNotNull(TEXT("Equipped weapon"), Weapon))
+	{
+		DestroyWorld();
+		return false;
+	}
+
+	// standing in an item's area sphere, so the character traces for items every frame
+	Character->IncrementOverlappedItemCount(1);
+
+	// let the character land and physics pick up the floor before anything traces against it
+	for (int32 i = 0; i < 4; i++)
+	{
+		World->Tick(LEVELTICK_All, DeltaTime);
+	}
+
+	// One frame of combat: pull the trigger and let the world tick the rest. Shots go through SendBullet,
+	// the item trace through TraceForItems, and an explosive under the crosshairs blows up in BulletHit
+	TWeakObjectPtr<AExplosive> Target;
+	auto RunFrame = [&](bool bMeasure)
+	{
+		// setup the game wouldn't do every frame stays out of the count
+		if (!Target.IsValid())
+		{
+			const UCameraComponent* Camera{ Character->GetFollowCamera() };
+			const FVector Location{ Camera->GetComponentLocation() + Camera->GetForwardVector() * TargetDistance };
+			Target = World->SpawnActor<AExplosive>(Location, FRotator::ZeroRotator);
+			Target->FindComponentByClass<UStaticMeshComponent>()->SetStaticMesh(Cube);
+		}
+		Weapon->ReloadAmmo(Weapon->GetMagazineCapacity() - Weapon->GetAmmo());
+
+		if (bMeasure)
+		{
+			Counter.StartCounting();
+		}
+		Character->FireButtonPressed();
+		Weapon->SetActiveStars();
+		World->Tick(LEVELTICK_All, DeltaTime);
+		Counter.StopCounting();
+	};
+
+	for (int32 Frame = 0; Frame < NumWarmupFrames; Frame++)
+	{
+		RunFrame(false);
+	}
+
+	int32 FrameAllocations[NumMeasuredFrames];
+	for (int32 Frame = 0; Frame < NumMeasuredFrames; Frame++)
+	{
+		RunFrame(true);
+		FrameAllocations[Frame] = Counter.GetNumAllocations();
+	}
+
+	for (int32 Frame = 0; Frame < NumMeasuredFrames; Frame++)
+	{
+		if (FrameAllocations[Frame] != 0)
+		{
+			AddError(FString::Printf(TEXT("Steady state frame %d made %d heap allocations"), Frame, FrameAllocations[Frame]));
+		}
+	}
+
+	DestroyWorld();
+	return !HasAnyErrors();
+#endif
+}
+
+#endif
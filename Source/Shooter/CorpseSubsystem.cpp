@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CorpseSubsystem.h"
+#include "Engine/World.h"
+#include "Enemy.h"
+#include "Shooter.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Corpses"), STAT_Corpses, STATGROUP_Shooter);
+
+UCorpseSubsystem::UCorpseSubsystem() :
+	MaxCorpses(16),
+	bFreezePose(true),
+	OffScreenTime(0.5f)
+{
+}
+
+void UCorpseSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	Corpses.RemoveAll([](const FCorpse& Corpse) { return !Corpse.Enemy.IsValid(); });
+	SET_DWORD_STAT(STAT_Corpses, Corpses.Num());
+	if (Corpses.Num() == 0) return;
+
+	// over budget, the corpse seen least recently goes first
+	while (Corpses.Num() > FMath::Max(MaxCorpses, 0))
+	{
+		int32 LeastRecent{ 0 };
+		for (int32 i = 1; i < Corpses.Num(); i++)
+		{
+			if (Corpses[i].Enemy->GetLastRenderTime() < Corpses[LeastRecent].Enemy->GetLastRenderTime())
+			{
+				LeastRecent = i;
+			}
+		}
+		Recycle(LeastRecent);
+	}
+
+	const float Now{ GetWorld()->GetTimeSeconds() };
+	for (int32 i = Corpses.Num() - 1; i >= 0; i--)
+	{
+		const FCorpse& Corpse{ Corpses[i] };
+		if (Now >= Corpse.ExpireTime && !Corpse.Enemy->WasRecentlyRendered(OffScreenTime))
+		{
+			Recycle(i);
+		}
+	}
+}
+
+TStatId UCorpseSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCorpseSubsystem, STATGROUP_Tickables);
+}
+
+bool UCorpseSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCorpseSubsystem::AddCorpse(AEnemy* Enemy, float Lifetime)
+{
+	if (Enemy == nullptr) return;
+	RemoveCorpse(Enemy);
+
+	if (bFreezePose)
+	{
+		Enemy->SetPoseFrozen(true);
+	}
+	Corpses.Add(FCorpse{ Enemy, GetWorld()->GetTimeSeconds() + Lifetime });
+}
+
+void UCorpseSubsystem::RemoveCorpse(AEnemy* Enemy)
+{
+	Corpses.RemoveAll([Enemy](const FCorpse& Corpse) { return Corpse.Enemy.Get() == Enemy; });
+}
+
+void UCorpseSubsystem::Recycle(int32 Index)
+{
+	AEnemy* Enemy{ Corpses[Index].Enemy.Get() };
+	Corpses.RemoveAt(Index, 1, false);
+	Enemy->Despawn();
+}
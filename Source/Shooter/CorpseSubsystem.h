@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CorpseSubsystem.generated.h"
+
+class AEnemy;
+
+struct FCorpse
+{
+	TWeakObjectPtr<AEnemy> Enemy;
+	// world time after which the corpse goes as soon as nobody is looking
+	float ExpireTime{ 0.f };
+};
+
+/**
+ * Keeps dead enemies within a budget.
+ * Corpses have their pose frozen once the death animation ends. Past MaxCorpses the corpse
+ * seen least recently is recycled; otherwise corpses are recycled once they have expired and are off screen.
+ * Recycled enemies go back to their wave spawner's pool, or are destroyed without one.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UCorpseSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UCorpseSubsystem();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Called when an enemy's death animation has finished, Lifetime is the least time it stays while on screen
+	void AddCorpse(AEnemy* Enemy, float Lifetime);
+	void RemoveCorpse(AEnemy* Enemy);
+
+	FORCEINLINE int32 GetNumCorpses() const { return Corpses.Num(); }
+
+private:
+
+	void Recycle(int32 Index);
+
+	// Most corpses kept at once
+	UPROPERTY(Config)
+	int32 MaxCorpses;
+
+	// Stop animating and updating the skeleton of corpses, they keep the last pose
+	UPROPERTY(Config)
+	bool bFreezePose;
+
+	// Corpses not rendered for this long count as off screen
+	UPROPERTY(Config)
+	float OffScreenTime;
+
+	TArray<FCorpse> Corpses;
+};
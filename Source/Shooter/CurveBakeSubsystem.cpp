@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CurveBakeSubsystem.h"
+#include "Curves/CurveFloat.h"
+#include "Curves/CurveVector.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+
+UCurveBakeSubsystem::UCurveBakeSubsystem() :
+	SamplesPerCurve(128)
+{
+}
+
+TSharedPtr<const FBakedCurve> UCurveBakeSubsystem::GetBakedCurve(const UCurveFloat* Curve)
+{
+	if (Curve == nullptr) return nullptr;
+
+	TSharedPtr<const FBakedCurve>& Baked{ FloatCurves.FindOrAdd(Curve) };
+	if (!Baked.IsValid())
+	{
+		TSharedRef<FBakedCurve> NewCurve{ MakeShared<FBakedCurve>() };
+		NewCurve->Bake(Curve, SamplesPerCurve);
+		Baked = NewCurve;
+	}
+	return Baked;
+}
+
+TSharedPtr<const FBakedVectorCurve> UCurveBakeSubsystem::GetBakedCurve(const UCurveVector* Curve)
+{
+	if (Curve == nullptr) return nullptr;
+
+	TSharedPtr<const FBakedVectorCurve>& Baked{ VectorCurves.FindOrAdd(Curve) };
+	if (!Baked.IsValid())
+	{
+		TSharedRef<FBakedVectorCurve> NewCurve{ MakeShared<FBakedVectorCurve>() };
+		NewCurve->Bake(Curve, SamplesPerCurve);
+		Baked = NewCurve;
+	}
+	return Baked;
+}
+
+TSharedPtr<const FBakedCurve> UCurveBakeSubsystem::Bake(const UObject* WorldContext, const UCurveFloat* Curve)
+{
+	if (Curve == nullptr) return nullptr;
+
+	const UWorld* World{ WorldContext ? WorldContext->GetWorld() : nullptr };
+	UGameInstance* GameInstance{ World ? World->GetGameInstance() : nullptr };
+	if (UCurveBakeSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UCurveBakeSubsystem>() : nullptr)
+	{
+		return Subsystem->GetBakedCurve(Curve);
+	}
+
+	TSharedRef<FBakedCurve> NewCurve{ MakeShared<FBakedCurve>() };
+	NewCurve->Bake(Curve, GetDefault<UCurveBakeSubsystem>()->SamplesPerCurve);
+	return NewCurve;
+}
+
+TSharedPtr<const FBakedVectorCurve> UCurveBakeSubsystem::Bake(const UObject* WorldContext, const UCurveVector* Curve)
+{
+	if (Curve == nullptr) return nullptr;
+
+	const UWorld* World{ WorldContext ? WorldContext->GetWorld() : nullptr };
+	UGameInstance* GameInstance{ World ? World->GetGameInstance() : nullptr };
+	if (UCurveBakeSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UCurveBakeSubsystem>() : nullptr)
+	{
+		return Subsystem->GetBakedCurve(Curve);
+	}
+
+	TSharedRef<FBakedVectorCurve> NewCurve{ MakeShared<FBakedVectorCurve>() };
+	NewCurve->Bake(Curve, GetDefault<UCurveBakeSubsystem>()->SamplesPerCurve);
+	return NewCurve;
+}
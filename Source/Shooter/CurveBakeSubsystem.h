@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "BakedCurve.h"
+#include "CurveBakeSubsystem.generated.h"
+
+class UCurveFloat;
+class UCurveVector;
+
+/**
+ * Bakes curve assets into lookup tables once and shares them.
+ * Every item using the same pulse or interp curve reads the same table.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UCurveBakeSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UCurveBakeSubsystem();
+
+	// Table for a curve, baked on first request; null for a null curve
+	TSharedPtr<const FBakedCurve> GetBakedCurve(const UCurveFloat* Curve);
+	TSharedPtr<const FBakedVectorCurve> GetBakedCurve(const UCurveVector* Curve);
+
+	// Convenience for actors, falls back to baking an unshared table outside of a game instance
+	static TSharedPtr<const FBakedCurve> Bake(const UObject* WorldContext, const UCurveFloat* Curve);
+	static TSharedPtr<const FBakedVectorCurve> Bake(const UObject* WorldContext, const UCurveVector* Curve);
+
+private:
+
+	// Samples per baked curve
+	UPROPERTY(Config)
+	int32 SamplesPerCurve;
+
+	TMap<FObjectKey, TSharedPtr<const FBakedCurve>> FloatCurves;
+	TMap<FObjectKey, TSharedPtr<const FBakedVectorCurve>> VectorCurves;
+};
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DamageQueueSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Enemy.h"
+#include "Shooter.h"
+#include "ShooterTimings.h"
+
+DECLARE_CYCLE_STAT(TEXT("Damage Queue"), STAT_DamageQueue, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Hits Merged"), STAT_DamageHitsMerged, STATGROUP_Shooter);
+
+void UDamageQueueSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SHOOTER_SCOPE_TIMING(DamageQueue);
+
+	ApplyQueuedDamage();
+}
+
+TStatId UDamageQueueSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDamageQueueSubsystem, STATGROUP_Tickables);
+}
+
+bool UDamageQueueSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDamageQueueSubsystem::QueueDamage(
+	AActor* Target,
+	float Amount,
+	AController* EventInstigator,
+	AActor* DamageCauser,
+	const FVector& HitLocation,
+	bool bHeadshot)
+{
+	if (Target == nullptr || Amount <= 0.f) return;
+
+	const FObjectKey TargetKey{ Target };
+	if (const int32* Index = PendingIndices.Find(TargetKey))
+	{
+		// already hit this frame, merge into the existing event
+		FQueuedDamage& Damage{ PendingDamage[*Index] };
+		Damage.Amount += Amount;
+		Damage.bHeadshot |= bHeadshot;
+		Damage.NumHits++;
+		return;
+	}
+
+	FQueuedDamage& Damage{ PendingDamage.AddDefaulted_GetRef() };
+	Damage.Target = Target;
+	Damage.EventInstigator = EventInstigator;
+	Damage.DamageCauser = DamageCauser;
+	Damage.Amount = Amount;
+	Damage.HitLocation = HitLocation;
+	Damage.bHeadshot = bHeadshot;
+	Damage.NumHits = 1;
+	PendingIndices.Add(TargetKey, PendingDamage.Num() - 1);
+}
+
+void UDamageQueueSubsystem::ApplyQueuedDamage()
+{
+	if (PendingDamage.Num() == 0) return;
+	SCOPE_CYCLE_COUNTER(STAT_DamageQueue);
+
+	// take this frame's batch, damage caused while applying (e.g. deaths) lands in the next one
+	Swap(ApplyingDamage, PendingDamage);
+	PendingDamage.Reset();
+	PendingIndices.Reset();
+
+	int32 HitsMerged{ 0 };
+	for (const FQueuedDamage& Damage : ApplyingDamage)
+	{
+		HitsMerged += Damage.NumHits - 1;
+
+		AActor* Target{ Damage.Target.Get() };
+		if (Target == nullptr) continue;
+
+		UGameplayStatics::ApplyDamage(
+			Target,
+			Damage.Amount,
+			Damage.EventInstigator.Get(),
+			Damage.DamageCauser.Get(),
+			UDamageType::StaticClass());
+
+		AEnemy* HitEnemy = Cast<AEnemy>(Target);
+		if (HitEnemy)
+		{
+			HitEnemy->ShowHitNumber(static_cast<int32>(Damage.Amount), Damage.HitLocation, Damage.bHeadshot);
+		}
+	}
+	ApplyingDamage.Reset();
+
+	INC_DWORD_STAT_BY(STAT_DamageHitsMerged, HitsMerged);
+}
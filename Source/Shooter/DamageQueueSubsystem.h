@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "DamageQueueSubsystem.generated.h"
+
+// All damage dealt to one target during a frame, merged into a single event
+struct FQueuedDamage
+{
+	TWeakObjectPtr<AActor> Target;
+
+	// instigator and causer of the first hit this frame
+	TWeakObjectPtr<AController> EventInstigator;
+	TWeakObjectPtr<AActor> DamageCauser;
+
+	float Amount{ 0.f };
+
+	// where the hit number is shown
+	FVector HitLocation{ FVector::ZeroVector };
+
+	// true if any of the merged hits was a headshot
+	bool bHeadshot{ false };
+
+	int32 NumHits{ 0 };
+};
+
+/**
+ * Collects damage during the frame and applies it once per target.
+ * Shotgun blasts and explosions hitting crowds produce one TakeDamage,
+ * one health bar refresh and one hit number per target instead of one per hit.
+ */
+UCLASS()
+class SHOOTER_API UDamageQueueSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Queue damage to be applied at the end of the frame
+	void QueueDamage(
+		AActor* Target,
+		float Amount,
+		AController* EventInstigator,
+		AActor* DamageCauser,
+		const FVector& HitLocation,
+		bool bHeadshot = false);
+
+	// Apply everything queued so far
+	void ApplyQueuedDamage();
+
+private:
+
+	// damage waiting for the end of the frame, one entry per target
+	TArray<FQueuedDamage> PendingDamage;
+
+	// index into PendingDamage for each target
+	TMap<FObjectKey, int32> PendingIndices;
+
+	// damage being applied right now, hits queued while applying go to the next batch
+	TArray<FQueuedDamage> ApplyingDamage;
+};
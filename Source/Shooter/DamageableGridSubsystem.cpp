@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DamageableGridSubsystem.h"
+
+UDamageableGridSubsystem::UDamageableGridSubsystem() :
+	CellSize(1000.f),
+	LastRefreshFrame(0)
+{
+}
+
+bool UDamageableGridSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDamageableGridSubsystem::Register(AActor* Actor)
+{
+	if (Actor == nullptr || ActorCells.Contains(Actor)) return;
+
+	const FIntVector Cell{ GetCell(Actor->GetActorLocation()) };
+	ActorCells.Add(Actor, Cell);
+	Cells.FindOrAdd(Cell).Add(Actor);
+}
+
+void UDamageableGridSubsystem::Unregister(AActor* Actor)
+{
+	FIntVector Cell;
+	if (!ActorCells.RemoveAndCopyValue(Actor, Cell)) return;
+
+	if (TArray<AActor*>* CellActors = Cells.Find(Cell))
+	{
+		CellActors->RemoveSingleSwap(Actor, false);
+	}
+}
+
+FIntVector UDamageableGridSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize));
+}
+
+void UDamageableGridSubsystem::Refresh()
+{
+	// actors only move once per frame, so one refresh serves every query this frame
+	if (LastRefreshFrame == GFrameCounter) return;
+	LastRefreshFrame = GFrameCounter;
+
+	for (TPair<AActor*, FIntVector>& Entry : ActorCells)
+	{
+		const FIntVector NewCell{ GetCell(Entry.Key->GetActorLocation()) };
+		if (NewCell == Entry.Value) continue;
+
+		// cell arrays are kept (not shrunk) so actors moving back and forth don't allocate
+		if (TArray<AActor*>* OldCell = Cells.Find(Entry.Value))
+		{
+			OldCell->RemoveSingleSwap(Entry.Key, false);
+		}
+		Cells.FindOrAdd(NewCell).Add(Entry.Key);
+		Entry.Value = NewCell;
+	}
+}
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameFramework/Actor.h"
+#include "DamageableGridSubsystem.generated.h"
+
+/**
+ * Uniform grid of every actor that can take area damage (characters, explosives).
+ * Actors register in BeginPlay and unregister in EndPlay; cell membership is refreshed
+ * lazily, at most once per frame, and only for actors that crossed a cell boundary.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UDamageableGridSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UDamageableGridSubsystem();
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	void Register(AActor* Actor);
+	void Unregister(AActor* Actor);
+
+	// Gather registered actors whose bounds reach within Radius of Center
+	template<typename AllocatorType>
+	void QuerySphere(const FVector& Center, float Radius, TArray<AActor*, AllocatorType>& OutActors)
+	{
+		Refresh();
+
+		const FIntVector MinCell{ GetCell(Center - FVector(Radius)) };
+		const FIntVector MaxCell{ GetCell(Center + FVector(Radius)) };
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+				{
+					const TArray<AActor*>* Cell{ Cells.Find(FIntVector(X, Y, Z)) };
+					if (Cell == nullptr) continue;
+
+					for (AActor* Actor : *Cell)
+					{
+						const float Reach{ Radius + Actor->GetSimpleCollisionRadius() };
+						if (FVector::DistSquared(Center, Actor->GetActorLocation()) <= Reach * Reach)
+						{
+							OutActors.Add(Actor);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	FORCEINLINE int32 GetNumRegistered() const { return ActorCells.Num(); }
+
+private:
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	// Move actors that changed cell since the last refresh
+	void Refresh();
+
+	// Edge length of a grid cell
+	UPROPERTY(Config)
+	float CellSize;
+
+	// cell each registered actor is currently filed under
+	TMap<AActor*, FIntVector> ActorCells;
+
+	TMap<FIntVector, TArray<AActor*>> Cells;
+
+	uint64 LastRefreshFrame;
+};
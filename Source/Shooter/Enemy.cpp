@@ -15,6 +15,16 @@
 #include "Components/CapsuleComponent.h"
 #include "Components/BoxComponent.h"
 #include "Engine/SkeletalMeshSocket.h"
+#include "DamageQueueSubsystem.h"
+#include "DamageableGridSubsystem.h"
+#include "ShooterHUD.h"
+#include "GameFramework/PlayerController.h"
+#include "RandomStreamSubsystem.h"
+#include "ShooterSnapshot.h"
+#include "EnemyWaveSpawner.h"
+#include "CorpseSubsystem.h"
+#include "BrainComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
 
 
 
@@ -39,7 +49,8 @@ AEnemy::AEnemy() :
 	bCanAttack(true),
 	AttackWaitTime(1.f),
 	bDying(false),
-	DeathTime(10.f)
+	DeathTime(10.f),
+	bDormant(false)
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -69,6 +80,22 @@ void AEnemy::BeginPlay()
 {
 	Super::BeginPlay();
 
+	if (URandomStreamSubsystem* Random = GetWorld()->GetSubsystem<URandomStreamSubsystem>())
+	{
+		// one key, the streams are seeded apart; each keeps its own count
+		const FRandomCounter Counter{ Random->AllocateCounter() };
+		for (FRandomCounter& StreamCounter : RandomCounters)
+		{
+			StreamCounter = Counter;
+		}
+	}
+
+	// so explosions can find us
+	if (UDamageableGridSubsystem* Grid = GetWorld()->GetSubsystem<UDamageableGridSubsystem>())
+	{
+		Grid->Register(this);
+	}
+
 	AgroSphere->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::AgroSphereOverlap);
 
 	CombatRangeSphere->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::CombatRangeOverlap);
@@ -104,6 +131,16 @@ void AEnemy::BeginPlay()
 		EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("CanAttack"), true);
 	}
 
+	SetPatrolPoints();
+
+	if (EnemyController)
+	{
+		EnemyController->RunBehaviorTree(BehaviorTree);
+	}
+}
+
+void AEnemy::SetPatrolPoints()
+{
 	const FVector WorldPatrolPoint = UKismetMathLibrary::TransformLocation(
 		GetActorTransform(),
 		PatrolPoint);
@@ -137,9 +174,175 @@ void AEnemy::BeginPlay()
 		EnemyController->GetBlackboardComponent()->SetValueAsVector(
 			TEXT("PatrolPoint2"),
 			WorldPatrolPoint2);
+	}
+}
 
-		EnemyController->RunBehaviorTree(BehaviorTree);
+void AEnemy::SetDormant(bool bNewDormant)
+{
+	if (bDormant == bNewDormant) return;
+	bDormant = bNewDormant;
+
+	SetActorHiddenInGame(bDormant);
+	SetActorEnableCollision(!bDormant);
+	SetActorTickEnabled(!bDormant);
+	GetMesh()->SetComponentTickEnabled(!bDormant);
+	GetCharacterMovement()->SetComponentTickEnabled(!bDormant);
+
+	// dormant enemies can't be hit by explosions
+	if (UDamageableGridSubsystem* Grid = GetWorld()->GetSubsystem<UDamageableGridSubsystem>())
+	{
+		if (bDormant)
+		{
+			Grid->Unregister(this);
+		}
+		else
+		{
+			Grid->Register(this);
+		}
+	}
+
+	UBrainComponent* Brain{ EnemyController ? EnemyController->GetBrainComponent() : nullptr };
+	if (Brain)
+	{
+		if (bDormant)
+		{
+			EnemyController->StopMovement();
+			Brain->PauseLogic(TEXT("Dormant"));
+		}
+		else
+		{
+			// start over from the root with the blackboard ResetForSpawn filled in
+			Brain->ResumeLogic(TEXT("Dormant"));
+			Brain->RestartLogic();
+		}
+	}
+}
+
+void AEnemy::ResetForSpawn(const FTransform& Transform)
+{
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+	SetActorLocationAndRotation(Transform.GetLocation(), Transform.GetRotation(), false, nullptr, ETeleportType::ResetPhysics);
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+
+	Health = MaxHealth;
+	bDying = false;
+	bStunned = false;
+	bCanHitReact = true;
+	bCanAttack = true;
+	bInAttackRange = false;
+	HideHealthBar();
+
+	DeactivateLeftWeapon();
+	DeactivateRightWeapon();
+
+	GetMesh()->bPauseAnims = false;
+	SetPoseFrozen(false);
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->StopAllMontages(0.f);
+	}
+
+	if (EnemyController)
+	{
+		UBlackboardComponent* Blackboard{ EnemyController->GetBlackboardComponent() };
+		Blackboard->ClearValue(TEXT("Target"));
+		Blackboard->SetValueAsBool(TEXT("Dead"), false);
+		Blackboard->SetValueAsBool(TEXT("Stunned"), false);
+		Blackboard->SetValueAsBool(TEXT("InAttackRange"), false);
+		Blackboard->SetValueAsBool(TEXT("CanAttack"), true);
+	}
+	SetPatrolPoints();
+}
+
+void AEnemy::Despawn()
+{
+	if (UCorpseSubsystem* Corpses = GetWorld()->GetSubsystem<UCorpseSubsystem>())
+	{
+		Corpses->RemoveCorpse(this);
+	}
+
+	if (AEnemyWaveSpawner* EnemySpawner = Spawner.Get())
+	{
+		EnemySpawner->ReturnToPool(this);
 	}
+	else
+	{
+		Destroy();
+	}
+}
+
+void AEnemy::Revive()
+{
+	if (!bDying) return;
+
+	if (UCorpseSubsystem* Corpses = GetWorld()->GetSubsystem<UCorpseSubsystem>())
+	{
+		Corpses->RemoveCorpse(this);
+	}
+
+	ResetForSpawn(GetActorTransform());
+	SetActorEnableCollision(true);
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	if (UDamageableGridSubsystem* Grid = GetWorld()->GetSubsystem<UDamageableGridSubsystem>())
+	{
+		Grid->Register(this);
+	}
+
+	if (UBrainComponent* Brain = EnemyController ? EnemyController->GetBrainComponent() : nullptr)
+	{
+		Brain->RestartLogic();
+	}
+}
+
+void AEnemy::SetPoseFrozen(bool bFrozen)
+{
+	GetMesh()->SetComponentTickEnabled(!bFrozen);
+	GetMesh()->bNoSkeletonUpdate = bFrozen;
+	SetActorTickEnabled(!bFrozen);
+}
+
+void AEnemy::SaveSnapshot(FEnemySnapshot& OutSnapshot) const
+{
+	OutSnapshot.Name = GetFName();
+	OutSnapshot.bLevelPlaced = HasAnyFlags(RF_WasLoaded);
+	OutSnapshot.Spawner = Spawner.IsValid() ? Spawner->GetFName() : NAME_None;
+	OutSnapshot.Location = FVector3f(GetActorLocation());
+	OutSnapshot.Yaw = GetActorRotation().Yaw;
+	OutSnapshot.Health = Health;
+
+	// patrol points were placed relative to where we started, keep them in world space
+	const UBlackboardComponent* Blackboard{ EnemyController ? EnemyController->GetBlackboardComponent() : nullptr };
+	if (Blackboard)
+	{
+		OutSnapshot.PatrolPoint = FVector3f(Blackboard->GetValueAsVector(TEXT("PatrolPoint")));
+		OutSnapshot.PatrolPoint2 = FVector3f(Blackboard->GetValueAsVector(TEXT("PatrolPoint2")));
+		OutSnapshot.bHasTarget = Blackboard->GetValueAsObject(TEXT("Target")) != nullptr;
+	}
+}
+
+void AEnemy::LoadSnapshot(const FEnemySnapshot& Snapshot)
+{
+	SetActorLocationAndRotation(FVector(Snapshot.Location), FRotator(0.f, Snapshot.Yaw, 0.f), false, nullptr, ETeleportType::ResetPhysics);
+	Health = Snapshot.Health;
+
+	UBlackboardComponent* Blackboard{ EnemyController ? EnemyController->GetBlackboardComponent() : nullptr };
+	if (Blackboard)
+	{
+		Blackboard->SetValueAsVector(TEXT("PatrolPoint"), FVector(Snapshot.PatrolPoint));
+		Blackboard->SetValueAsVector(TEXT("PatrolPoint2"), FVector(Snapshot.PatrolPoint2));
+		Blackboard->SetValueAsObject(TEXT("Target"), Snapshot.bHasTarget ? UGameplayStatics::GetPlayerPawn(this, 0) : nullptr);
+	}
+}
+
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UDamageableGridSubsystem* Grid = GetWorld()->GetSubsystem<UDamageableGridSubsystem>())
+	{
+		Grid->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AEnemy::ShowHealthBar_Implementation()
@@ -160,6 +363,17 @@ void AEnemy::Die()
 
 	HideHealthBar();
 
+	// corpses don't block, move or get caught in explosions
+	SetActorEnableCollision(false);
+	GetCharacterMovement()->DisableMovement();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	DeactivateLeftWeapon();
+	DeactivateRightWeapon();
+	if (UDamageableGridSubsystem* Grid = GetWorld()->GetSubsystem<UDamageableGridSubsystem>())
+	{
+		Grid->Unregister(this);
+	}
+
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
 	if (AnimInstance && DeathMontage)
 	{
@@ -187,7 +401,7 @@ void AEnemy::PlayHitMontage(FName Section, float PlayRate)
 
 	bCanHitReact = false;
 
-	const float HitReactTime{ FMath::FRandRange(HitReactTimeMin, HitReactTimeMax) };
+	const float HitReactTime{ URandomStreamSubsystem::Get(this, ERandomStream::AI).FRandRange(GetRandomCounter(ERandomStream::AI), HitReactTimeMin, HitReactTimeMax) };
 
 	GetWorldTimerManager().SetTimer(
 		HitReactTimer,
@@ -283,7 +497,7 @@ void AEnemy::PlayAttackMontage(FName Section, float PlayRate)
 FName AEnemy::GetAttackSectionName()
 {
 	FName SectionName;
-	const int32 Section{ FMath::RandRange(1, 4) };
+	const int32 Section{ URandomStreamSubsystem::Get(this, ERandomStream::AI).RandRange(GetRandomCounter(ERandomStream::AI), 1, 4) };
 	switch (Section)
 	{
 	case 1:
@@ -306,12 +520,16 @@ void AEnemy::DoDamage(AShooterCharacter* Victim)
 {
 	if (Victim == nullptr) return;
 
-	UGameplayStatics::ApplyDamage(
-		Victim,
-		BaseDamage,
-		EnemyController,
-		this,
-		UDamageType::StaticClass());
+	UDamageQueueSubsystem* DamageQueue = GetWorld()->GetSubsystem<UDamageQueueSubsystem>();
+	if (DamageQueue)
+	{
+		DamageQueue->QueueDamage(
+			Victim,
+			BaseDamage,
+			EnemyController,
+			this,
+			Victim->GetActorLocation());
+	}
 
 	if (Victim->GetMeleeImpactSound())
 	{
@@ -342,7 +560,7 @@ void AEnemy::StunCharacter(AShooterCharacter* Victim)
 {
 	if (Victim)
 	{
-		const float Stun{ FMath::FRandRange(0.f, 1.f) };
+		const float Stun{ URandomStreamSubsystem::Get(this, ERandomStream::Combat).FRand(GetRandomCounter(ERandomStream::Combat)) };
 		if (Stun <= Victim->GetStunChance())
 		{
 			Victim->Stun();
@@ -363,6 +581,14 @@ void AEnemy::ResetCanAttack()
 void AEnemy::FinishDeath()
 {
 	GetMesh()->bPauseAnims = true;
+
+	// the corpse budget decides when we go
+	if (UCorpseSubsystem* Corpses = GetWorld()->GetSubsystem<UCorpseSubsystem>())
+	{
+		Corpses->AddCorpse(this, DeathTime);
+		return;
+	}
+
 	GetWorldTimerManager().SetTimer(
 		DeathTimer,
 		this,
@@ -372,7 +598,7 @@ void AEnemy::FinishDeath()
 
 void AEnemy::DestroyEnemy()
 {
-	Destroy();
+	Despawn();
 }
 
 void AEnemy::OnLeftWeaponOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
@@ -441,8 +667,22 @@ void AEnemy::BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, ACo
 	}
 	if (ImpactParticles)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, HitResult.Location, FRotator(0.f), true);
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, HitResult.Location, FRotator(0.f), FVector(1.f), true, EPSCPoolMethod::AutoRelease);
+	}
+}
+
+void AEnemy::ShowHitNumber(int32 Damage, FVector HitLocation, bool bHeadshot)
+{
+	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(this, 0);
+	if (PlayerController)
+	{
+		AShooterHUD* ShooterHUD = Cast<AShooterHUD>(PlayerController->GetHUD());
+		if (ShooterHUD)
+		{
+			ShooterHUD->AddHitNumber(Damage, HitLocation, bHeadshot);
+		}
 	}
+	OnHitNumberShown(Damage, HitLocation, bHeadshot);
 }
 
 float AEnemy::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
@@ -468,7 +708,7 @@ float AEnemy::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AC
 	ShowHealthBar();
 
 	// determine whether bullet hit stuns
-	const float Stunned = FMath::FRandRange(0.f, 1.f);
+	const float Stunned = URandomStreamSubsystem::Get(this, ERandomStream::Combat).FRand(GetRandomCounter(ERandomStream::Combat));
 	if (Stunned <= StunChance)
 	{
 		// Stun the enemy
@@ -480,3 +720,8 @@ float AEnemy::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AC
 	return DamageAmount;
 }
 
+
+EPhysicalSurface AEnemy::GetSurfaceType()
+{
+	return GroundSurface.GetSurface(this);
+}
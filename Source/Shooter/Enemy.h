@@ -5,8 +5,13 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "BUlletHitInterface.h"
+#include "GroundSurfaceCache.h"
+#include "RandomStreamSubsystem.h"
 #include "Enemy.generated.h"
 
+struct FEnemySnapshot;
+class AEnemyWaveSpawner;
+
 UCLASS()
 class SHOOTER_API AEnemy : public ACharacter, public IBUlletHitInterface
 {
@@ -19,6 +24,7 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	UFUNCTION(BlueprintNativeEvent)
 		void ShowHealthBar();
@@ -106,9 +112,16 @@ protected:
 	UFUNCTION(BlueprintCallable)
 	void FinishDeath();
 
+	// Surface under the enemy for footstep effects
+	UFUNCTION(BlueprintCallable)
+	EPhysicalSurface GetSurfaceType();
+
 	UFUNCTION()
 	void DestroyEnemy();
 
+	// Patrol points are authored relative to the enemy, put them in the blackboard relative to where it is now
+	void SetPatrolPoints();
+
 private:
 
 	// particles to spawn when hit by a bullet
@@ -240,6 +253,20 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float DeathTime;
 
+	// Surface under us, from the movement component's floor
+	FGroundSurfaceCache GroundSurface;
+
+	// our rolls, independent of how many other enemies rolled before us and of our rolls in other streams
+	FRandomCounter RandomCounters[static_cast<int32>(ERandomStream::Max)];
+
+	FORCEINLINE FRandomCounter& GetRandomCounter(ERandomStream Stream) { return RandomCounters[static_cast<int32>(Stream)]; }
+
+	// pooled enemies are hidden, without collision and with their behavior tree paused
+	bool bDormant;
+
+	// pool we go back to instead of being destroyed, unset for level placed enemies
+	TWeakObjectPtr<AEnemyWaveSpawner> Spawner;
+
 public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -255,10 +282,38 @@ public:
 
 
 
-	//buggy in UE5.1
-	UFUNCTION(BlueprintimplementableEvent)
-		void ShowHitNumber(int32 Damage, FVector HitLocation);
+	// Shows a floating damage number through the player's HUD
+	UFUNCTION(BlueprintCallable)
+		void ShowHitNumber(int32 Damage, FVector HitLocation, bool bHeadshot = false);
+
+	// Called after the HUD has drawn a hit number, for extra feedback. The number itself is already on screen
+	UFUNCTION(BlueprintImplementableEvent)
+		void OnHitNumberShown(int32 Damage, FVector HitLocation, bool bHeadshot);
 
 	FORCEINLINE UBehaviorTree* GetBehaviorTree() const { return BehaviorTree; }
 
+	FORCEINLINE bool IsDying() const { return bDying; }
+	FORCEINLINE bool IsDormant() const { return bDormant; }
+	FORCEINLINE bool IsInAttackRange() const { return bInAttackRange; }
+
+	FORCEINLINE void SetSpawner(AEnemyWaveSpawner* InSpawner) { Spawner = InSpawner; }
+
+	// Called by the wave spawner when pooling and activating
+	void SetDormant(bool bNewDormant);
+
+	// Alive again at full health at Transform, with a fresh blackboard and animation state
+	void ResetForSpawn(const FTransform& Transform);
+
+	// Back to the pool, or destroyed without one
+	void Despawn();
+
+	// Undoes Die, alive again at full health where it lies
+	void Revive();
+
+	// Corpses keep their last pose without animating or updating bones
+	void SetPoseFrozen(bool bFrozen);
+
+	void SaveSnapshot(FEnemySnapshot& OutSnapshot) const;
+	void LoadSnapshot(const FEnemySnapshot& Snapshot);
+
 };
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "BehaviorTree/BehaviorTreeComponent.h"
 #include "BehaviorTree/BehaviorTree.h"
 #include "Enemy.h"
+#include "ScheduledBehaviorTreeComponent.h"
 
 
 AEnemyController::AEnemyController()
@@ -13,8 +14,11 @@ AEnemyController::AEnemyController()
 	BlackboardComponent = CreateDefaultSubobject<UBlackboardComponent>(TEXT("BlackboardComponent"));
 	check(BlackboardComponent);
 
-	BehaviorTreeComponent = CreateDefaultSubobject<UBehaviorTreeComponent>(TEXT("BehaviorTreeComponent"));
+	BehaviorTreeComponent = CreateDefaultSubobject<UScheduledBehaviorTreeComponent>(TEXT("BehaviorTreeComponent"));
 	check(BehaviorTreeComponent);
+
+	// RunBehaviorTree uses the brain component, otherwise it makes an unscheduled one of its own
+	BrainComponent = BehaviorTreeComponent;
 }
 
 void AEnemyController::OnPossess(APawn* InPawn)
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyWaveSpawner.h"
+#include "Kismet/GameplayStatics.h"
+#include "Enemy.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Wave"), STAT_SpawnWave, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Enemies"), STAT_PooledEnemies, STATGROUP_Shooter);
+
+AEnemyWaveSpawner::AEnemyWaveSpawner() :
+	PoolSize(50),
+	WaveSize(10),
+	TimeBetweenWaves(0.f),
+	NumActive(0),
+	NextSpawnPoint(0)
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	SetRootComponent(CreateDefaultSubobject<USceneComponent>(TEXT("Root")));
+}
+
+void AEnemyWaveSpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Pool.Reserve(PoolSize);
+	for (int32 i = 0; i < PoolSize; i++)
+	{
+		if (AEnemy* Enemy = SpawnPooledEnemy())
+		{
+			Pool.Add(Enemy);
+		}
+	}
+	INC_DWORD_STAT_BY(STAT_PooledEnemies, Pool.Num());
+
+	if (TimeBetweenWaves > 0.f)
+	{
+		GetWorldTimerManager().SetTimer(WaveTimer, this, &AEnemyWaveSpawner::SpawnTimedWave, TimeBetweenWaves, true);
+	}
+}
+
+void AEnemyWaveSpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	DEC_DWORD_STAT_BY(STAT_PooledEnemies, Pool.Num());
+	Super::EndPlay(EndPlayReason);
+}
+
+AEnemy* AEnemyWaveSpawner::SpawnPooledEnemy()
+{
+	if (EnemyClass == nullptr) return nullptr;
+
+	AEnemy* Enemy{ GetWorld()->SpawnActorDeferred<AEnemy>(EnemyClass, GetActorTransform(), nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn) };
+	if (Enemy == nullptr) return nullptr;
+
+	// possessed and running its behavior tree by the end of BeginPlay, no overlaps on the way
+	Enemy->AutoPossessAI = EAutoPossessAI::Spawned;
+	Enemy->SetActorEnableCollision(false);
+	Enemy->SetSpawner(this);
+	UGameplayStatics::FinishSpawningActor(Enemy, GetActorTransform());
+
+	Enemy->SetDormant(true);
+	return Enemy;
+}
+
+int32 AEnemyWaveSpawner::SpawnWave(int32 Count)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnWave);
+
+	int32 NumSpawned{ 0 };
+	for (; NumSpawned < Count; NumSpawned++)
+	{
+		FTransform Transform{ GetActorTransform() };
+		if (SpawnPoints.Num() > 0)
+		{
+			Transform.SetLocation(GetActorTransform().TransformPosition(SpawnPoints[NextSpawnPoint]));
+		}
+
+		if (SpawnEnemy(Transform) == nullptr) break;
+		if (SpawnPoints.Num() > 0)
+		{
+			NextSpawnPoint = (NextSpawnPoint + 1) % SpawnPoints.Num();
+		}
+	}
+	return NumSpawned;
+}
+
+AEnemy* AEnemyWaveSpawner::SpawnEnemy(const FTransform& Transform)
+{
+	const bool bFromPool{ Pool.Num() > 0 };
+	AEnemy* Enemy{ bFromPool ? Pool.Pop(false) : SpawnPooledEnemy() };
+	if (Enemy == nullptr) return nullptr;
+	if (bFromPool)
+	{
+		DEC_DWORD_STAT(STAT_PooledEnemies);
+	}
+
+	Enemy->ResetForSpawn(Transform);
+	Enemy->SetDormant(false);
+	NumActive++;
+	return Enemy;
+}
+
+void AEnemyWaveSpawner::SpawnTimedWave()
+{
+	SpawnWave(WaveSize);
+}
+
+void AEnemyWaveSpawner::ReturnToPool(AEnemy* Enemy)
+{
+	if (Enemy == nullptr || Enemy->IsDormant()) return;
+
+	Enemy->SetDormant(true);
+	Pool.Add(Enemy);
+	NumActive = FMath::Max(NumActive - 1, 0);
+	INC_DWORD_STAT(STAT_PooledEnemies);
+}
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "EnemyWaveSpawner.generated.h"
+
+class AEnemy;
+
+/**
+ * Spawns waves of enemies from a pool filled when play begins.
+ * Pooled enemies are fully spawned, possessed and running a paused behavior tree, so a wave
+ * only teleports, resets and wakes them. Dead enemies come back to the pool instead of being destroyed.
+ */
+UCLASS()
+class SHOOTER_API AEnemyWaveSpawner : public AActor
+{
+	GENERATED_BODY()
+	
+public:	
+	AEnemyWaveSpawner();
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// Activates up to Count enemies spread over the spawn points, returns how many were activated
+	UFUNCTION(BlueprintCallable, Category = Waves)
+	int32 SpawnWave(int32 Count);
+
+	// Activates a single enemy at Transform, used to bring back wave enemies from a save
+	AEnemy* SpawnEnemy(const FTransform& Transform);
+
+	// Called by enemies when their death timer runs out
+	void ReturnToPool(AEnemy* Enemy);
+
+	FORCEINLINE int32 GetNumPooled() const { return Pool.Num(); }
+	FORCEINLINE int32 GetNumActive() const { return NumActive; }
+
+private:
+
+	// Spawns a dormant enemy into the pool
+	AEnemy* SpawnPooledEnemy();
+
+	UFUNCTION()
+	void SpawnTimedWave();
+
+	UPROPERTY(EditAnywhere, Category = Waves, meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<AEnemy> EnemyClass;
+
+	// Enemies spawned up front, a wave bigger than what is left in the pool spawns the rest
+	UPROPERTY(EditAnywhere, Category = Waves, meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	int32 PoolSize;
+
+	// Where wave enemies appear, relative to the spawner; the spawner itself when empty
+	UPROPERTY(EditAnywhere, Category = Waves, meta = (AllowPrivateAccess = "true", MakeEditWidget = "true"))
+	TArray<FVector> SpawnPoints;
+
+	// Enemies per timed wave
+	UPROPERTY(EditAnywhere, Category = Waves, meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	int32 WaveSize;
+
+	// Seconds between timed waves, 0 only spawns waves through SpawnWave
+	UPROPERTY(EditAnywhere, Category = Waves, meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float TimeBetweenWaves;
+
+	// dormant enemies ready for the next wave
+	UPROPERTY()
+	TArray<AEnemy*> Pool;
+
+	int32 NumActive;
+
+	// spawn point the next enemy uses, wraps around
+	int32 NextSpawnPoint;
+
+	FTimerHandle WaveTimer;
+};
@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ExplosionSubsystem.h"
+#include "Curves/CurveFloat.h"
+#include "Async/ParallelFor.h"
+#include "Misc/MemStack.h"
+#include "DamageableGridSubsystem.h"
+#include "DamageQueueSubsystem.h"
+#include "Explosive.h"
+#include "Shooter.h"
+#include "ShooterTimings.h"
+#include "TraceSchedulerSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Explosion Damage"), STAT_ExplosionDamage, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion Occlusion Traces"), STAT_ExplosionTraces, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pending Detonations"), STAT_PendingDetonations, STATGROUP_Shooter);
+
+UExplosionSubsystem::UExplosionSubsystem() :
+	MaxDetonationsPerFrame(4),
+	ChainReactionDelay(0.15f),
+	MinTracesForParallel(16)
+{
+}
+
+void UExplosionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const float Now{ GetWorld()->GetTimeSeconds() };
+	int32 NumReady{ 0 };
+	while (NumReady < PendingDetonations.Num() &&
+		NumReady < MaxDetonationsPerFrame &&
+		PendingDetonations[NumReady].DetonateTime <= Now)
+	{
+		NumReady++;
+	}
+	SET_DWORD_STAT(STAT_PendingDetonations, PendingDetonations.Num());
+	if (NumReady == 0) return;
+
+	// copy out first, detonating queues more explosives onto PendingDetonations
+	TArray<FPendingDetonation, TInlineAllocator<8>> Ready{ PendingDetonations.GetData(), NumReady };
+	PendingDetonations.RemoveAt(0, NumReady, false);
+
+	for (const FPendingDetonation& Detonation : Ready)
+	{
+		AExplosive* Explosive{ Detonation.Explosive.Get() };
+		if (Explosive)
+		{
+			Explosive->Explode(
+				Explosive->GetActorLocation(),
+				Detonation.Shooter.Get(),
+				Detonation.ShooterController.Get());
+		}
+	}
+}
+
+TStatId UExplosionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UExplosionSubsystem, STATGROUP_Tickables);
+}
+
+bool UExplosionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UExplosionSubsystem::ApplyRadialDamage(const FRadialDamageParams& Params)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ExplosionDamage);
+	SHOOTER_SCOPE_TIMING(Explosions);
+
+	UWorld* World{ GetWorld() };
+	UDamageableGridSubsystem* Grid{ World->GetSubsystem<UDamageableGridSubsystem>() };
+	if (Grid == nullptr || Params.Radius <= 0.f) return;
+
+	// candidates and occlusion results only live for this explosion, take them from the frame arena
+	FMemMark Mark(FMemStack::Get());
+	TArray<AActor*, TMemStackAllocator<>> Candidates;
+	Grid->QuerySphere(Params.Origin, Params.Radius, Candidates);
+	Candidates.RemoveSingleSwap(Params.DamageCauser, false);
+	if (Candidates.Num() == 0) return;
+
+	// only level geometry blocks a blast, characters don't shield each other
+	TArray<bool, TMemStackAllocator<>> Occluded;
+	Occluded.SetNumUninitialized(Candidates.Num());
+	const FCollisionObjectQueryParams ObjectParams{ ECC_WorldStatic };
+	auto TraceCandidate = [World, &Params, &ObjectParams, &Candidates, &Occluded](int32 Index)
+	{
+		FCollisionQueryParams QueryParams{ SCENE_QUERY_STAT(ExplosionOcclusion), false, Params.DamageCauser };
+		QueryParams.AddIgnoredActor(Candidates[Index]);
+		Occluded[Index] = World->LineTraceTestByObjectType(
+			Params.Origin,
+			Candidates[Index]->GetActorLocation(),
+			ObjectParams,
+			QueryParams);
+	};
+	ParallelFor(Candidates.Num(), TraceCandidate, Candidates.Num() < MinTracesForParallel);
+	INC_DWORD_STAT_BY(STAT_ExplosionTraces, Candidates.Num());
+	UTraceSchedulerSubsystem::AddTraces(World, ETraceCategory::Combat, Candidates.Num());
+
+	UDamageQueueSubsystem* DamageQueue{ World->GetSubsystem<UDamageQueueSubsystem>() };
+	for (int32 i = 0; i < Candidates.Num(); i++)
+	{
+		if (Occluded[i]) continue;
+		AActor* Actor{ Candidates[i] };
+
+		AExplosive* Explosive = Cast<AExplosive>(Actor);
+		if (Explosive)
+		{
+			QueueDetonation(Explosive, Params.Shooter, Params.ShooterController);
+			continue;
+		}
+
+		const float Distance{ static_cast<float>(FVector::Dist(Params.Origin, Actor->GetActorLocation())) };
+		const float Alpha{ FMath::Clamp(Distance / Params.Radius, 0.f, 1.f) };
+		const float Multiplier{ Params.FalloffCurve ?
+			Params.FalloffCurve->GetFloatValue(Alpha) :
+			FMath::Lerp(1.f, Params.MinDamageFraction, Alpha) };
+
+		if (DamageQueue)
+		{
+			DamageQueue->QueueDamage(
+				Actor,
+				Params.BaseDamage * Multiplier,
+				Params.ShooterController,
+				Params.Shooter,
+				Actor->GetActorLocation());
+		}
+	}
+}
+
+void UExplosionSubsystem::QueueDetonation(AExplosive* Explosive, AActor* Shooter, AController* ShooterController)
+{
+	// each explosive only goes off once, however many blasts reach it
+	if (Explosive == nullptr || !Explosive->MarkDetonationPending()) return;
+
+	FPendingDetonation& Detonation{ PendingDetonations.AddDefaulted_GetRef() };
+	Detonation.Explosive = Explosive;
+	Detonation.Shooter = Shooter;
+	Detonation.ShooterController = ShooterController;
+	Detonation.DetonateTime = GetWorld()->GetTimeSeconds() + ChainReactionDelay;
+}
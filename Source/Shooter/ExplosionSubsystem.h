@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ExplosionSubsystem.generated.h"
+
+class AExplosive;
+class UCurveFloat;
+
+// Everything needed to deal one explosion's damage
+struct FRadialDamageParams
+{
+	FVector Origin{ FVector::ZeroVector };
+	float Radius{ 0.f };
+	float BaseDamage{ 0.f };
+
+	// damage multiplier by normalized distance (0 at the origin, 1 at the edge), linear when null
+	const UCurveFloat* FalloffCurve{ nullptr };
+
+	// damage fraction at the edge when there is no falloff curve
+	float MinDamageFraction{ 0.f };
+
+	// actor that exploded, never damaged by its own blast
+	AActor* DamageCauser{ nullptr };
+
+	AActor* Shooter{ nullptr };
+	AController* ShooterController{ nullptr };
+};
+
+// An explosive set off by another explosion, waiting for its turn
+struct FPendingDetonation
+{
+	TWeakObjectPtr<AExplosive> Explosive;
+	TWeakObjectPtr<AActor> Shooter;
+	TWeakObjectPtr<AController> ShooterController;
+	float DetonateTime{ 0.f };
+};
+
+/**
+ * Radial damage for explosions.
+ * Candidates come from the damageable grid, occlusion traces run as one parallel batch
+ * and chain reactions are spread over frames by a budgeted detonation queue.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UExplosionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UExplosionSubsystem();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Damage every unoccluded damageable actor in range and queue any explosives caught in the blast
+	void ApplyRadialDamage(const FRadialDamageParams& Params);
+
+	// Set off an explosive on a later frame
+	void QueueDetonation(AExplosive* Explosive, AActor* Shooter, AController* ShooterController);
+
+private:
+
+	// Max queued explosives set off per frame
+	UPROPERTY(Config)
+	int32 MaxDetonationsPerFrame;
+
+	// Seconds between an explosion and the explosives it sets off
+	UPROPERTY(Config)
+	float ChainReactionDelay;
+
+	// Occlusion batches smaller than this are traced on the game thread
+	UPROPERTY(Config)
+	int32 MinTracesForParallel;
+
+	// FIFO, DetonateTime is non-decreasing
+	TArray<FPendingDetonation> PendingDetonations;
+};
@@ -6,14 +6,17 @@
 #include "Sound/SoundCue.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Components/SphereComponent.h"
-#include "GameFramework/Character.h"
-#include "Kismet/GameplayStatics.h"
+#include "DamageableGridSubsystem.h"
+#include "ExplosionSubsystem.h"
 
 
 
 // Sets default values
 AExplosive::AExplosive() :
-	Damage(70.f)
+	Damage(70.f),
+	DamageFalloffCurve(nullptr),
+	MinDamageFraction(0.25f),
+	bDetonationPending(false)
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -23,6 +26,9 @@ AExplosive::AExplosive() :
 
 	OverlapSphere = CreateDefaultSubobject<USphereComponent>(TEXT("OverlapSphere"));
 	OverlapSphere->SetupAttachment(GetRootComponent());
+	// only its radius is used, the damageable grid finds the actors
+	OverlapSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	OverlapSphere->SetGenerateOverlapEvents(false);
 }
 
 // Called when the game starts or when spawned
@@ -30,6 +36,21 @@ void AExplosive::BeginPlay()
 {
 	Super::BeginPlay();
 	
+	// explosives can be set off by other explosions
+	if (UDamageableGridSubsystem* Grid = GetWorld()->GetSubsystem<UDamageableGridSubsystem>())
+	{
+		Grid->Register(this);
+	}
+}
+
+void AExplosive::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UDamageableGridSubsystem* Grid = GetWorld()->GetSubsystem<UDamageableGridSubsystem>())
+	{
+		Grid->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -40,6 +61,21 @@ void AExplosive::Tick(float DeltaTime)
 }
 
 void AExplosive::BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, AController* ShooterController)
+{
+	if (!MarkDetonationPending()) return;
+
+	Explode(HitResult.Location, Shooter, ShooterController);
+}
+
+bool AExplosive::MarkDetonationPending()
+{
+	if (bDetonationPending) return false;
+
+	bDetonationPending = true;
+	return true;
+}
+
+void AExplosive::Explode(const FVector& Location, AActor* Shooter, AController* ShooterController)
 {
 	if (ImpactSound)
 	{
@@ -47,26 +83,24 @@ void AExplosive::BulletHit_Implementation(FHitResult HitResult, AActor* Shooter,
 	}
 	if (ExplodeParticles)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplodeParticles, HitResult.Location, FRotator(0.f), true);
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplodeParticles, Location, FRotator(0.f), true);
 	}
-	// Apply explosive Damage
-
-	TArray<AActor*> OverlappingActors;
-	GetOverlappingActors(OverlappingActors, ACharacter::StaticClass());
 
-	for (auto Actor : OverlappingActors)
+	// Apply explosive Damage
+	UExplosionSubsystem* Explosions = GetWorld()->GetSubsystem<UExplosionSubsystem>();
+	if (Explosions)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Actor damage by explosive: %s"), *Actor->GetName());
-
-		UGameplayStatics::ApplyDamage(
-			Actor,
-			Damage,
-			ShooterController,
-			Shooter,
-			UDamageType::StaticClass()
-		);
+		FRadialDamageParams Params;
+		Params.Origin = GetActorLocation();
+		Params.Radius = OverlapSphere->GetScaledSphereRadius();
+		Params.BaseDamage = Damage;
+		Params.FalloffCurve = DamageFalloffCurve;
+		Params.MinDamageFraction = MinDamageFraction;
+		Params.DamageCauser = this;
+		Params.Shooter = Shooter;
+		Params.ShooterController = ShooterController;
+		Explosions->ApplyRadialDamage(Params);
 	}
 
 	Destroy();
 }
-
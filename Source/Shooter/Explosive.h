@@ -19,6 +19,7 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
 
@@ -34,7 +35,7 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	class UStaticMeshComponent* ExplosiveMesh;
 
-	// overlap sphere used to determine what actors overlap during explosion
+	// sphere whose radius is the blast radius
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	class USphereComponent* OverlapSphere;
 
@@ -42,10 +43,27 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float Damage;
 
+	// damage multiplier by distance, 0 at the center and 1 at the edge of the blast
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	class UCurveFloat* DamageFalloffCurve;
+
+	// damage fraction at the edge of the blast when there's no falloff curve
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true", ClampMin = "0.0", ClampMax = "1.0"))
+	float MinDamageFraction;
+
+	// true once this explosive has exploded or is queued to
+	bool bDetonationPending;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
 	virtual void BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, AController* ShooterController) override;
 
+	// Play effects, damage everything in the blast radius and destroy this explosive
+	void Explode(const FVector& Location, AActor* Shooter, AController* ShooterController);
+
+	// Claim this explosive for a detonation, false if it already has one
+	bool MarkDetonationPending();
+
 };
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GroundSurfaceCache.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "Shooter.h"
+#include "TraceSchedulerSubsystem.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ground Surface Lookups"), STAT_GroundSurfaceLookups, STATGROUP_Shooter);
+
+EPhysicalSurface FGroundSurfaceCache::GetSurface(const ACharacter* Character)
+{
+	const UCharacterMovementComponent* Movement{ Character ? Character->GetCharacterMovement() : nullptr };
+	if (Movement == nullptr || !Movement->CurrentFloor.IsWalkableFloor()) return Surface;
+
+	const FHitResult& FloorHit{ Movement->CurrentFloor.HitResult };
+	UPrimitiveComponent* Component{ FloorHit.GetComponent() };
+	const FIntPoint HitCell{
+		FMath::FloorToInt(FloorHit.ImpactPoint.X / CellSize),
+		FMath::FloorToInt(FloorHit.ImpactPoint.Y / CellSize) };
+	if (Component == FloorComponent.Get() && HitCell == Cell) return Surface;
+
+	INC_DWORD_STAT(STAT_GroundSurfaceLookups);
+	FloorComponent = Component;
+	Cell = HitCell;
+
+	// the floor sweep doesn't ask for materials, trace just the floor component for the face or layer under the feet
+	const UPhysicalMaterial* PhysMaterial{ FloorHit.PhysMaterial.Get() };
+	if (PhysMaterial == nullptr && Component)
+	{
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GroundSurface), true);
+		QueryParams.bReturnPhysicalMaterial = true;
+
+		const FVector TraceOffset{ 0.f, 0.f, 50.f };
+		FHitResult SurfaceHit;
+		UTraceSchedulerSubsystem::AddTraces(Character, ETraceCategory::Cosmetic, 1);
+		if (Component->LineTraceComponent(SurfaceHit, FloorHit.ImpactPoint + TraceOffset, FloorHit.ImpactPoint - TraceOffset, QueryParams))
+		{
+			PhysMaterial = SurfaceHit.PhysMaterial.Get();
+		}
+		else
+		{
+			const FBodyInstance* Body{ Component->GetBodyInstance() };
+			PhysMaterial = Body ? Body->GetSimplePhysicalMaterial() : nullptr;
+		}
+	}
+	Surface = UPhysicalMaterial::DetermineSurfaceType(PhysMaterial);
+	return Surface;
+}
@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/ChaosEngineInterface.h"
+
+class ACharacter;
+class UPrimitiveComponent;
+
+// Surface type under a character, read from the floor its movement component already found
+struct SHOOTER_API FGroundSurfaceCache
+{
+	// The physical material is looked up when the floor component changes or the character
+	// moves into another cell, so landscape layers and multi-material floors are still told apart.
+	// In the air the last floor's surface is kept, so the landing step still sounds right
+	EPhysicalSurface GetSurface(const ACharacter* Character);
+
+	// Width of the square cells the surface is cached for
+	static constexpr float CellSize{ 100.f };
+
+private:
+	TWeakObjectPtr<const UPrimitiveComponent> FloorComponent;
+	FIntPoint Cell{ 0, 0 };
+	EPhysicalSurface Surface{ EPhysicalSurface::SurfaceType_Default };
+};
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InterpAnchorHeap.h"
+
+void FInterpAnchorHeap::Init(int32 NumAnchors)
+{
+	NumAnchors = FMath::Max(NumAnchors, 0);
+	Heap.SetNumUninitialized(NumAnchors);
+	Positions.SetNumUninitialized(NumAnchors);
+	Counts.SetNumZeroed(NumAnchors);
+
+	// equal counts, so anchor order is already heap order
+	for (int32 i = 0; i < NumAnchors; i++)
+	{
+		Heap[i] = i;
+		Positions[i] = i;
+	}
+}
+
+void FInterpAnchorHeap::Adjust(int32 Anchor, int32 Delta)
+{
+	if (!Counts.IsValidIndex(Anchor) || Delta == 0) return;
+
+	Counts[Anchor] = FMath::Max(Counts[Anchor] + Delta, 0);
+	if (Delta < 0)
+	{
+		SiftUp(Positions[Anchor]);
+	}
+	else
+	{
+		SiftDown(Positions[Anchor]);
+	}
+}
+
+bool FInterpAnchorHeap::Less(int32 A, int32 B) const
+{
+	return Counts[A] != Counts[B] ? Counts[A] < Counts[B] : A < B;
+}
+
+void FInterpAnchorHeap::SiftUp(int32 Position)
+{
+	while (Position > 0)
+	{
+		const int32 Parent{ (Position - 1) / 2 };
+		if (!Less(Heap[Position], Heap[Parent])) break;
+		SwapPositions(Position, Parent);
+		Position = Parent;
+	}
+}
+
+void FInterpAnchorHeap::SiftDown(int32 Position)
+{
+	while (true)
+	{
+		const int32 Left{ Position * 2 + 1 };
+		const int32 Right{ Left + 1 };
+		int32 Smallest{ Position };
+		if (Left < Heap.Num() && Less(Heap[Left], Heap[Smallest]))
+		{
+			Smallest = Left;
+		}
+		if (Right < Heap.Num() && Less(Heap[Right], Heap[Smallest]))
+		{
+			Smallest = Right;
+		}
+		if (Smallest == Position) break;
+		SwapPositions(Position, Smallest);
+		Position = Smallest;
+	}
+}
+
+void FInterpAnchorHeap::SwapPositions(int32 A, int32 B)
+{
+	Heap.Swap(A, B);
+	Positions[Heap[A]] = A;
+	Positions[Heap[B]] = B;
+}
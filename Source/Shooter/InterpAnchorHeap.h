@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Indexed min-heap of interp anchors keyed by how many items are flying to each, ties go to the lower anchor
+struct SHOOTER_API FInterpAnchorHeap
+{
+	// All anchors start with no items
+	void Init(int32 NumAnchors);
+
+	// Anchor with the fewest items, INDEX_NONE when there are no anchors
+	FORCEINLINE int32 Top() const { return Heap.Num() > 0 ? Heap[0] : INDEX_NONE; }
+
+	FORCEINLINE int32 GetCount(int32 Anchor) const { return Counts[Anchor]; }
+	FORCEINLINE int32 Num() const { return Heap.Num(); }
+
+	// Change an anchor's item count and restore the heap order
+	void Adjust(int32 Anchor, int32 Delta);
+
+private:
+	bool Less(int32 A, int32 B) const;
+	void SiftUp(int32 Position);
+	void SiftDown(int32 Position);
+	void SwapPositions(int32 A, int32 B);
+
+	// anchors in heap order
+	TArray<int32> Heap;
+
+	// position in Heap of each anchor
+	TArray<int32> Positions;
+
+	// items flying to each anchor
+	TArray<int32> Counts;
+};
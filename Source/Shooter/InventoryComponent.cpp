@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryComponent.h"
+#include "Item.h"
+
+UInventoryComponent::UInventoryComponent() :
+	Capacity(6),
+	NumItems(0),
+	bInventoryChanged(false),
+	PendingEquipFrom(INDEX_NONE),
+	PendingEquipTo(INDEX_NONE)
+{
+	bWantsInitializeComponent = true;
+
+	// only ticks on frames with something to broadcast
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+}
+
+void UInventoryComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	Slots.Init(nullptr, Capacity);
+	NumItems = 0;
+
+	// every slot starts free, bits past Capacity stay clear
+	FreeSlotMask.Init(0, FMath::DivideAndRoundUp(Capacity, 64));
+	for (int32 Slot = 0; Slot < Capacity; Slot++)
+	{
+		SetSlotFree(Slot, true);
+	}
+}
+
+void UInventoryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SetComponentTickEnabled(false);
+
+	if (PendingEquipTo != INDEX_NONE)
+	{
+		const int32 From{ PendingEquipFrom };
+		const int32 To{ PendingEquipTo };
+		PendingEquipFrom = INDEX_NONE;
+		PendingEquipTo = INDEX_NONE;
+		if (From != To)
+		{
+			EquipFlushedDelegate.Broadcast(From, To);
+		}
+	}
+
+	if (bInventoryChanged)
+	{
+		bInventoryChanged = false;
+		InventoryChangedDelegate.Broadcast();
+	}
+}
+
+int32 UInventoryComponent::AddItem(AItem* Item)
+{
+	const int32 Slot{ FindFreeSlot() };
+	if (Item == nullptr || Slot == INDEX_NONE) return INDEX_NONE;
+
+	SetItem(Slot, Item);
+	return Slot;
+}
+
+AItem* UInventoryComponent::SetItem(int32 Slot, AItem* Item)
+{
+	if (!Slots.IsValidIndex(Slot)) return nullptr;
+
+	AItem* Previous{ Slots[Slot] };
+	Slots[Slot] = Item;
+	NumItems += (Item != nullptr) - (Previous != nullptr);
+	SetSlotFree(Slot, Item == nullptr);
+
+	// the slot array is the only place slot indices are assigned
+	if (Item)
+	{
+		Item->SetSlotIndex(Slot);
+	}
+	MarkDirty();
+
+	return Previous;
+}
+
+AItem* UInventoryComponent::RemoveItem(int32 Slot)
+{
+	return SetItem(Slot, nullptr);
+}
+
+int32 UInventoryComponent::FindFreeSlot() const
+{
+	for (int32 Word = 0; Word < FreeSlotMask.Num(); Word++)
+	{
+		if (FreeSlotMask[Word] != 0)
+		{
+			return Word * 64 + static_cast<int32>(FMath::CountTrailingZeros64(FreeSlotMask[Word]));
+		}
+	}
+	return INDEX_NONE;
+}
+
+TArray<AItem*> UInventoryComponent::GetItems() const
+{
+	int32 NumSlots{ Slots.Num() };
+	while (NumSlots > 0 && Slots[NumSlots - 1] == nullptr)
+	{
+		NumSlots--;
+	}
+	return TArray<AItem*>(Slots.GetData(), NumSlots);
+}
+
+void UInventoryComponent::QueueEquip(int32 FromSlot, int32 ToSlot)
+{
+	// keep where the first equip this frame started, so the bar animates once to the final slot
+	if (PendingEquipTo == INDEX_NONE)
+	{
+		PendingEquipFrom = FromSlot;
+	}
+	PendingEquipTo = ToSlot;
+	SetComponentTickEnabled(true);
+}
+
+void UInventoryComponent::SetSlotFree(int32 Slot, bool bFree)
+{
+	const uint64 Bit{ 1ull << (Slot & 63) };
+	if (bFree)
+	{
+		FreeSlotMask[Slot >> 6] |= Bit;
+	}
+	else
+	{
+		FreeSlotMask[Slot >> 6] &= ~Bit;
+	}
+}
+
+void UInventoryComponent::MarkDirty()
+{
+	bInventoryChanged = true;
+	SetComponentTickEnabled(true);
+}
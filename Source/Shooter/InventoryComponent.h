@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "InventoryComponent.generated.h"
+
+class AItem;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FInventoryChangedDelegate);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FInventoryEquipDelegate, int32 /* FromSlot */, int32 /* ToSlot */);
+
+/**
+ * Fixed-capacity item slots.
+ * Slots are allocated once when the component initializes and never move, free slots are
+ * tracked in a bitmask so finding one doesn't scan the items, and change notifications are
+ * merged into one broadcast per frame.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SHOOTER_API UInventoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UInventoryComponent();
+
+	virtual void InitializeComponent() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Put an item in the first free slot, returns the slot or INDEX_NONE when full
+	int32 AddItem(AItem* Item);
+
+	// Replace whatever is in a slot, returns the previous item
+	AItem* SetItem(int32 Slot, AItem* Item);
+
+	// Empty a slot, returns the item that was in it
+	AItem* RemoveItem(int32 Slot);
+
+	// First free slot, INDEX_NONE when full
+	int32 FindFreeSlot() const;
+
+	// Items in slot order up to the last occupied slot, the layout of the character's old Inventory array
+	UFUNCTION(BlueprintPure, Category = Inventory)
+	TArray<AItem*> GetItems() const;
+
+	// Queue the inventory bar's equip animation, merged with any other equips this frame
+	void QueueEquip(int32 FromSlot, int32 ToSlot);
+
+	FORCEINLINE AItem* GetItem(int32 Slot) const { return Slots.IsValidIndex(Slot) ? Slots[Slot] : nullptr; }
+	FORCEINLINE int32 GetCapacity() const { return Slots.Num(); }
+	FORCEINLINE int32 GetNumItems() const { return NumItems; }
+	FORCEINLINE bool IsFull() const { return NumItems >= Slots.Num(); }
+
+	// Broadcast at most once per frame after slots change
+	UPROPERTY(BlueprintAssignable, Category = Delegate)
+	FInventoryChangedDelegate InventoryChangedDelegate;
+
+	// Broadcast at most once per frame with the first slot equipped from and the last slot equipped to
+	FInventoryEquipDelegate EquipFlushedDelegate;
+
+private:
+
+	void SetSlotFree(int32 Slot, bool bFree);
+
+	// Tick once to flush pending notifications
+	void MarkDirty();
+
+	// Number of slots
+	UPROPERTY(EditDefaultsOnly, Category = Inventory, meta = (AllowPrivateAccess = "true", ClampMin = "1", ClampMax = "256"))
+	int32 Capacity;
+
+	// one entry per slot, null when empty
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
+	TArray<AItem*> Slots;
+
+	// bit set for every free slot
+	TArray<uint64, TInlineAllocator<4>> FreeSlotMask;
+
+	int32 NumItems;
+
+	bool bInventoryChanged;
+
+	// INDEX_NONE in PendingEquipTo when no equip is queued
+	int32 PendingEquipFrom;
+	int32 PendingEquipTo;
+};
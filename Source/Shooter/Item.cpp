@@ -3,13 +3,17 @@
 
 #include "Item.h"
 #include "Components/BoxComponent.h"
-#include "Components/WidgetComponent.h"
 #include "Components/SphereComponent.h"
 #include "ShooterCharacter.h"
 #include "Camera/CameraComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Sound/SoundCue.h"
 #include "Curves/CurveVector.h"
+#include "CurveBakeSubsystem.h"
+#include "PickupInterpSubsystem.h"
+#include "ItemSleepSubsystem.h"
+#include "ItemCollisionProfile.h"
+#include "ShooterSnapshot.h"
 
 
 // Sets default values
@@ -38,7 +42,9 @@ AItem::AItem() :
 	FresnelReflectFraction(4.f),
 	PulseCurveTime(5.f),
 	SlotIndex(0),
-	bCharacterInventoryFull(false)
+	bCharacterInventoryFull(false),
+	bAsleep(false),
+	SleepIndex(INDEX_NONE)
 {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -51,9 +57,6 @@ AItem::AItem() :
 	CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 	CollisionBox->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
 
-	PickupWidget = CreateDefaultSubobject<UWidgetComponent>(TEXT("PickupWidget"));
-	PickupWidget->SetupAttachment(GetRootComponent());
-
 	AreaSphere = CreateDefaultSubobject<USphereComponent>(TEXT("Area Sphere"));
 	AreaSphere->SetupAttachment(GetRootComponent());
 }
@@ -63,15 +66,15 @@ void AItem::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Hide Pickup Widget
-	if (PickupWidget)
-	{
-		PickupWidget->SetVisibility(false);
-	}
-
 	// Sets Active stars array based on item rarity
 	SetActiveStars();
 
+	// sample the curves once, ticking only reads the tables
+	ItemZTable = UCurveBakeSubsystem::Bake(this, ItemZCurve);
+	ItemScaleTable = UCurveBakeSubsystem::Bake(this, ItemScaleCurve);
+	PulseTable = UCurveBakeSubsystem::Bake(this, PulseCurve);
+	InterpPulseTable = UCurveBakeSubsystem::Bake(this, InterpPulseCurve);
+
 	// Setup Overlap for Area Sphere
 	AreaSphere->OnComponentBeginOverlap.AddDynamic(this, &AItem::OnSphereoverlap);
 	AreaSphere->OnComponentEndOverlap.AddDynamic(this, &AItem::OnSphereEndOverlap);
@@ -83,6 +86,21 @@ void AItem::BeginPlay()
 	InitializeCustomDepth();
 
 	StartPulseTimer();
+
+	if (UItemSleepSubsystem* Sleep = GetWorld()->GetSubsystem<UItemSleepSubsystem>())
+	{
+		Sleep->Register(this);
+	}
+}
+
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UItemSleepSubsystem* Sleep = GetWorld()->GetSubsystem<UItemSleepSubsystem>())
+	{
+		Sleep->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AItem::ItemTurning(float DeltaTime)
@@ -125,10 +143,7 @@ void AItem::OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor*
 void AItem::SetActiveStars()
 {
 	// the 0 element is NOT used
-	for (int32 i = 0; i <= 5; i++)
-	{
-		ActiveStars.Add(false);
-	}
+	ActiveStars.Init(false, 6);
 
 	switch (ItemRarity)
 	{
@@ -166,95 +181,19 @@ void AItem::SetActiveStars()
 
 void AItem::SetItemProperties(EItemState State)
 {
-	switch (State)
-	{
-	case EItemState::EIS_Pickup:
-		// Set Mesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set area sphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Overlap);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-		// sset collision box properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		break;
-
-	case EItemState::EIS_Equipped:
-		PickupWidget->SetVisibility(false);
-		// Set Mesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set area sphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// set collision box properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		break;
-
-	case EItemState::EIS_Falling:
-		// Set mesh properties
-		ItemMesh->SetSimulatePhysics(true);
-		ItemMesh->SetEnableGravity(true);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionResponseToChannel(ECollisionChannel::ECC_WorldStatic, ECollisionResponse::ECR_Block);
-		// Set area sphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// set collision box properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		break;
-
-	case EItemState::EIS_EquipInterping:
-		PickupWidget->SetVisibility(false);
-		// Set Mesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set area sphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// set collision box properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		break;
-
-	case EItemState::EIS_PickedUp:
-		PickupWidget->SetVisibility(false);
-		// Set Mesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(false);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set area sphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// set collision box properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	}
+	// Set mesh, area sphere and collision box properties from the precomputed profiles
+	ItemCollisionProfile::Apply(ItemMesh, ItemCollisionProfile::Get(State, EItemComponent::Mesh));
+	ItemCollisionProfile::Apply(AreaSphere, ItemCollisionProfile::Get(State, EItemComponent::AreaSphere));
+	ItemCollisionProfile::Apply(CollisionBox, ItemCollisionProfile::Get(State, EItemComponent::CollisionBox));
 }
 
 void AItem::FinishInterping()
 {
 	bInterping = false;
+	if (UPickupInterpSubsystem* PickupInterp = GetWorld()->GetSubsystem<UPickupInterpSubsystem>())
+	{
+		PickupInterp->Unregister(this);
+	}
 	if (Character)
 	{
 		// subtract 1 from the item count of the interp location struct
@@ -270,72 +209,37 @@ void AItem::FinishInterping()
 	DisableCustomDepth();
 }
 
-void AItem::ItemInterp(float DeltaTime)
+void AItem::ApplyInterpFrame(const FVector& TargetLocation, float CameraYaw, float ZCurveValue, float Scale, float DeltaTime)
 {
-	if (!bInterping) return;
-
-	if (Character && ItemZCurve)
-	{
-		// Elapsed time since we started ItemInterpTimer
-		const float ElapsedTime = GetWorldTimerManager().GetTimerElapsed(ItemInterpTimer);
-		// Get Curve value corresponding to ElapsedTime
-		const float CurveValue = ItemZCurve->GetFloatValue(ElapsedTime);
-
-		// Get item initial location when the curve started
-		FVector ItemLocation = ItemInterpStartLocation;
-		// Get location in front of the camera
-		const FVector CameraInterpLocation{ GetInterpLocation() };
-		// Vector from item to camera Interp Location, X and Y are zeroed out
-		const FVector ItemToCamera{ FVector(0.f, 0.f, (CameraInterpLocation - ItemLocation).Z) };
-		// Scale factor to multiply with CurveValue
-		const float DeltaZ = ItemToCamera.Size();
-
-		const FVector CurrentLocation{ GetActorLocation() };
-		// Interpolated X value
-		const float InterpXValue = FMath::FInterpTo(CurrentLocation.X, CameraInterpLocation.X, DeltaTime, 30.0f);
-		// Interpolated Y value
-		const float InterpYValue = FMath::FInterpTo(CurrentLocation.Y, CameraInterpLocation.Y, DeltaTime, 30.0f);
-
-		// Set X and Y of item location to interped values
-		ItemLocation.X = InterpXValue;
-		ItemLocation.Y = InterpYValue;
-
-		// adding curve value to the z component of the Initial Location (scaled by deltaZ)
-		ItemLocation.Z += CurveValue * DeltaZ;
-		SetActorLocation(ItemLocation, true, nullptr, ETeleportType::TeleportPhysics);
-
-		// Camera rotation this frame
-		const FRotator CameraRotation{ Character->GetFollowCamera()->GetComponentRotation() };
-		// Camera Rotation plus initial yaw offset
-		FRotator ItemRotation{ 0.f, CameraRotation.Yaw + InterpInitialYawOffset, 0.f };
-		SetActorRotation(ItemRotation, ETeleportType::TeleportPhysics);
-
-		if (ItemScaleCurve)
-		{
-			const float ScaleCurveValue = ItemScaleCurve->GetFloatValue(ElapsedTime);
-			SetActorScale3D(FVector(ScaleCurveValue, ScaleCurveValue, ScaleCurveValue));
-		}
-	}
-	
+	// Get item initial location when the curve started
+	FVector ItemLocation = ItemInterpStartLocation;
+	// Scale factor to multiply with the Z curve value, only the height difference to the target
+	const float DeltaZ = FMath::Abs(TargetLocation.Z - ItemLocation.Z);
+
+	const FVector CurrentLocation{ GetActorLocation() };
+	// Set X and Y of item location to interped values
+	ItemLocation.X = FMath::FInterpTo(CurrentLocation.X, TargetLocation.X, DeltaTime, 30.0f);
+	ItemLocation.Y = FMath::FInterpTo(CurrentLocation.Y, TargetLocation.Y, DeltaTime, 30.0f);
+
+	// adding curve value to the z component of the Initial Location (scaled by deltaZ)
+	ItemLocation.Z += ZCurveValue * DeltaZ;
+
+	// Camera yaw plus initial yaw offset
+	const FRotator ItemRotation{ 0.f, CameraYaw + InterpInitialYawOffset, 0.f };
+
+	// one unswept update instead of separate location, rotation and scale moves, collision is off while interping.
+	// The pickup subsystem defers what follows from it until every item has moved
+	GetRootComponent()->SetWorldTransform(
+		FTransform(ItemRotation, ItemLocation, FVector(Scale)),
+		false,
+		nullptr,
+		ETeleportType::TeleportPhysics);
 }
 
-
-
-FVector AItem::GetInterpLocation()
+int32 AItem::GetInterpTargetIndex() const
 {
-	if (Character == nullptr) return FVector(0.f);
-	
-	switch (ItemType)
-	{
-	case EItemType::EIT_Ammo:
-		return Character->GetInterpLocation(InterpLocIndex).SceneComponent->GetComponentLocation();
-		break;
-
-	case EItemType::EIT_Weapon:
-		return Character->GetInterpLocation(0).SceneComponent->GetComponentLocation();
-		break;
-	}
-	return FVector();
+	// weapons always fly to the weapon interp location
+	return ItemType == EItemType::EIT_Weapon ? 0 : InterpLocIndex;
 }
 
 void AItem::PlayPickupSound(bool bForcePlaySound)
@@ -445,17 +349,17 @@ void AItem::UpdatePulse()
 	switch (ItemState)
 	{
 	case EItemState::EIS_Pickup:
-		if (PulseCurve)
+		if (PulseTable)
 		{
 			ElapsedTime = GetWorldTimerManager().GetTimerElapsed(PulseTimer);
-			CurveValue = PulseCurve->GetVectorValue(ElapsedTime);
+			CurveValue = PulseTable->Evaluate(ElapsedTime);
 		}
 		break;
 	case EItemState::EIS_EquipInterping:
-		if (InterpPulseCurve)
+		if (InterpPulseTable)
 		{
 			ElapsedTime = GetWorldTimerManager().GetTimerElapsed(ItemInterpTimer);
-			CurveValue = InterpPulseCurve->GetVectorValue(ElapsedTime);
+			CurveValue = InterpPulseTable->Evaluate(ElapsedTime);
 		}
 		break;
 	}
@@ -514,8 +418,6 @@ void AItem::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	// handle item interping when in the EquipInterping state
-	ItemInterp(DeltaTime);
 	//ItemTurning(DeltaTime);
 
 	// Get crve values from pulse curve and set dynamic material parameters.
@@ -538,9 +440,77 @@ void AItem::StartPulseTimer()
 void AItem::SetItemState(EItemState State)
 {
 	ItemState = State;
+	if (bAsleep && !CanSleep())
+	{
+		// waking restores the properties for the new state
+		if (UItemSleepSubsystem* Sleep = GetWorld()->GetSubsystem<UItemSleepSubsystem>())
+		{
+			Sleep->Wake(this);
+			return;
+		}
+	}
 	SetItemProperties(State);
 }
 
+void AItem::SetAsleep(bool bSleep)
+{
+	if (bAsleep == bSleep) return;
+	bAsleep = bSleep;
+
+	SetActorTickEnabled(!bAsleep);
+	if (bAsleep)
+	{
+		GetWorldTimerManager().ClearTimer(PulseTimer);
+
+		// put the plain material back so the dynamic instance can be collected
+		if (DynamicMaterialInstance)
+		{
+			ItemMesh->SetMaterial(MaterialIndex, MaterialInstance);
+			DynamicMaterialInstance = nullptr;
+		}
+
+		DisableOverlaps();
+	}
+	else
+	{
+		if (MaterialInstance && DynamicMaterialInstance == nullptr)
+		{
+			DynamicMaterialInstance = UMaterialInstanceDynamic::Create(MaterialInstance, this);
+			DynamicMaterialInstance->SetVectorParameterValue(TEXT("FresnelColor"), GlowColor);
+			ItemMesh->SetMaterial(MaterialIndex, DynamicMaterialInstance);
+			EnableGlowMaterial();
+		}
+
+		SetItemProperties(ItemState);
+		StartPulseTimer();
+	}
+}
+
+void AItem::SaveSnapshot(FItemSnapshot& OutSnapshot) const
+{
+	OutSnapshot.Location = FVector3f(GetActorLocation());
+	OutSnapshot.Rotation = FQuat4f(GetActorQuat());
+	OutSnapshot.Rarity = static_cast<uint8>(ItemRarity);
+	OutSnapshot.ItemCount = ItemCount;
+	OutSnapshot.SlotIndex = SlotIndex;
+}
+
+void AItem::LoadSnapshotDefaults(const FItemSnapshot& Snapshot)
+{
+	// rarity drives the colors and stars set up in OnConstruction
+	ItemRarity = static_cast<EItemRarity>(Snapshot.Rarity);
+}
+
+void AItem::LoadSnapshot(const FItemSnapshot& Snapshot)
+{
+	ItemCount = Snapshot.ItemCount;
+}
+
+void AItem::DisableOverlaps()
+{
+	AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
 void AItem::StartItemCurve(AShooterCharacter* Char, bool bForcePlaySound)
 {
 	// Store a handle to the character
@@ -561,6 +531,10 @@ void AItem::StartItemCurve(AShooterCharacter* Char, bool bForcePlaySound)
 	SetItemState(EItemState::EIS_EquipInterping);
 	GetWorldTimerManager().ClearTimer(PulseTimer);
 	GetWorldTimerManager().SetTimer(ItemInterpTimer, this, &AItem::FinishInterping, ZCurveTime);
+	if (UPickupInterpSubsystem* PickupInterp = GetWorld()->GetSubsystem<UPickupInterpSubsystem>())
+	{
+		PickupInterp->Register(this);
+	}
 
 	// Get initial Yaw of the camera
 	const float CameraRotationYaw(Character->GetFollowCamera()->GetComponentRotation().Yaw);
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Engine/DataTable.h"
+#include "BakedCurve.h"
 #include "Item.generated.h"
 
 UENUM(BlueprintType)
@@ -63,11 +64,16 @@ struct FItemRarityTable : public FTableRowBase
 	int32 CustomDepthStencil;
 };
 
+struct FItemSnapshot;
+
 UCLASS()
 class SHOOTER_API AItem : public AActor
 {
 	GENERATED_BODY()
 
+	// refreshes the rarity stars every frame
+	friend class FCombatAllocationTest;
+
 public:
 	// Sets default values for this actor's properties
 	AItem();
@@ -76,6 +82,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Called when overlapping area sphere
 	UFUNCTION()
 	void OnSphereoverlap(
@@ -103,19 +111,16 @@ protected:
 	// Called when item interp timer is finished
 	void FinishInterping();
 
-	// Handles Item interpolation when in the EquipInterping state
-	void ItemInterp(float DeltaTime);
-
 	void ItemTurning(float DeltaTime);
 
-	// GetinterpLocation based on item type
-	FVector GetInterpLocation();
-
 	void PlayPickupSound(bool bForcePlaySounf = false);
 
 
 	virtual void InitializeCustomDepth();
 
+	// Turn off every overlap the item listens for while it sleeps, SetItemProperties turns them back on
+	virtual void DisableOverlaps();
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 
 	void EnableGlowMaterial();
@@ -143,10 +148,6 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 		class UBoxComponent* CollisionBox;
 
-	/** Popup widget for when the player looks at the item */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-		class UWidgetComponent* PickupWidget;
-
 	// Enables Item Tracing when overlapped
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	class USphereComponent* AreaSphere;
@@ -257,6 +258,12 @@ private:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	float PulseCurveTime;
 
+	// lookup tables baked from the curves above in BeginPlay, shared by every item using the same curve
+	TSharedPtr<const FBakedCurve> ItemZTable;
+	TSharedPtr<const FBakedCurve> ItemScaleTable;
+	TSharedPtr<const FBakedVectorCurve> PulseTable;
+	TSharedPtr<const FBakedVectorCurve> InterpPulseTable;
+
 	
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	float GlowAmount;
@@ -283,6 +290,12 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Inventory", meta = (AllowPrivateAccess = "true"))
 		bool bCharacterInventoryFull;
 
+	// true while put to sleep by the item sleep subsystem
+	bool bAsleep;
+
+	// position in the item sleep subsystem's array, INDEX_NONE when not registered
+	int32 SleepIndex;
+
 	// item rarity data table
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "DataTable", meta = (AllowPrivateAccess = "true"))
 	class UDataTable* ItemRarityDataTable;
@@ -307,7 +320,6 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Rarity", meta = (AllowPrivateAccess = "true"))
 	UTexture2D* IconBackground;
 public:
-	FORCEINLINE UWidgetComponent* GetPickupWidget() const { return PickupWidget; }
 	FORCEINLINE USphereComponent* GetAreaSphere() const { return AreaSphere; }
 	FORCEINLINE UBoxComponent* GetCollisionBox() const { return CollisionBox; }
 	FORCEINLINE EItemState GetItemState() const { return ItemState; }
@@ -317,11 +329,32 @@ public:
 	FORCEINLINE void SetEquippedSound(USoundCue* Sound) { EquipSound = Sound; }
 	
 	void SetItemState(EItemState State);
+
+	// Only pickups lying in the world can sleep
+	FORCEINLINE bool CanSleep() const { return ItemState == EItemState::EIS_Pickup; }
+	FORCEINLINE bool IsAsleep() const { return bAsleep; }
+
+	// Called by the item sleep subsystem. Sleeping items don't tick, pulse or overlap
+	void SetAsleep(bool bSleep);
+
+	// Kept by the item sleep subsystem so registering and unregistering don't search its array
+	FORCEINLINE int32 GetSleepIndex() const { return SleepIndex; }
+	FORCEINLINE void SetSleepIndex(int32 Index) { SleepIndex = Index; }
+
+	// Saving and loading, LoadSnapshotDefaults runs on a deferred spawn before construction and LoadSnapshot after it
+	virtual void SaveSnapshot(FItemSnapshot& OutSnapshot) const;
+	virtual void LoadSnapshotDefaults(const FItemSnapshot& Snapshot);
+	virtual void LoadSnapshot(const FItemSnapshot& Snapshot);
 	FORCEINLINE	USkeletalMeshComponent* GetItemMesh() const { return ItemMesh; }
 	// Called from the AShooterCharacter class
 	void StartItemCurve(AShooterCharacter* Char, bool bForcePlaySound = false);
 
 	FORCEINLINE int32 GetItemCount() const { return ItemCount; }
+	FORCEINLINE const FString& GetItemName() const { return ItemName; }
+	FORCEINLINE const TArray<bool>& GetActiveStars() const { return ActiveStars; }
+	FORCEINLINE FLinearColor GetLightColor() const { return LightColor; }
+	FORCEINLINE FLinearColor GetDarkColor() const { return DarkColor; }
+	FORCEINLINE bool IsCharacterInventoryFull() const { return bCharacterInventoryFull; }
 
 	virtual void EnableCustomDepth();
 	virtual void DisableCustomDepth();
@@ -331,6 +364,16 @@ public:
 	FORCEINLINE void SetSlotIndex(int32 Index) { SlotIndex = Index; }
 
 	FORCEINLINE void SetCharacter(AShooterCharacter* Char) { Character = Char; }
+	FORCEINLINE AShooterCharacter* GetCharacter() const { return Character; }
+
+	FORCEINLINE const FBakedCurve* GetItemZTable() const { return ItemZTable.Get(); }
+	FORCEINLINE const FBakedCurve* GetItemScaleTable() const { return ItemScaleTable.Get(); }
+
+	// Index in the character's interp locations this item flies to, based on item type
+	int32 GetInterpTargetIndex() const;
+
+	// Called by the pickup interp subsystem with this frame's target location, camera yaw and curve values
+	void ApplyInterpFrame(const FVector& TargetLocation, float CameraYaw, float ZCurveValue, float Scale, float DeltaTime);
 	 
 	FORCEINLINE void SetCharacterInventoryFull(bool bFull) { bCharacterInventoryFull = bFull; }
 	FORCEINLINE void SetItemName(FString Name) { ItemName = Name; }
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemCollisionProfile.h"
+#include "Components/PrimitiveComponent.h"
+
+namespace
+{
+	using FStateProfiles = FItemComponentProfile[static_cast<int32>(EItemComponent::Max)];
+
+	FItemComponentProfile MakeProfile(
+		ECollisionEnabled::Type CollisionEnabled,
+		ECollisionResponse AllChannels,
+		bool bPhysics = false,
+		bool bVisible = true)
+	{
+		FItemComponentProfile Profile;
+		Profile.CollisionEnabled = CollisionEnabled;
+		Profile.Responses = FCollisionResponseContainer(AllChannels);
+		Profile.bSimulatePhysics = bPhysics;
+		Profile.bEnableGravity = bPhysics;
+		Profile.bVisible = bVisible;
+		return Profile;
+	}
+
+	struct FProfileTable
+	{
+		FStateProfiles States[static_cast<int32>(EItemState::EIS_Max) + 1];
+
+		FProfileTable()
+		{
+			const FItemComponentProfile Disabled{ MakeProfile(ECollisionEnabled::NoCollision, ECR_Ignore) };
+			for (FStateProfiles& State : States)
+			{
+				for (FItemComponentProfile& Profile : State)
+				{
+					Profile = Disabled;
+				}
+			}
+
+			// lying in the world, the sphere starts item tracing and the box is what the trace hits
+			FStateProfiles& Pickup{ States[static_cast<int32>(EItemState::EIS_Pickup)] };
+			Pickup[static_cast<int32>(EItemComponent::AreaSphere)] = MakeProfile(ECollisionEnabled::QueryOnly, ECR_Overlap);
+			FItemComponentProfile& PickupBox{ Pickup[static_cast<int32>(EItemComponent::CollisionBox)] };
+			PickupBox.CollisionEnabled = ECollisionEnabled::QueryAndPhysics;
+			PickupBox.Responses.SetResponse(ECC_Visibility, ECR_Block);
+
+			// dropped, the mesh simulates and only lands on level geometry
+			FItemComponentProfile& FallingMesh{ States[static_cast<int32>(EItemState::EIS_Falling)][static_cast<int32>(EItemComponent::Mesh)] };
+			FallingMesh = MakeProfile(ECollisionEnabled::QueryAndPhysics, ECR_Ignore, true);
+			FallingMesh.Responses.SetResponse(ECC_WorldStatic, ECR_Block);
+
+			// in the inventory but not in hand
+			States[static_cast<int32>(EItemState::EIS_PickedUp)][static_cast<int32>(EItemComponent::Mesh)].bVisible = false;
+		}
+	};
+}
+
+const FItemComponentProfile& ItemCollisionProfile::Get(EItemState State, EItemComponent Component)
+{
+	static const FProfileTable Table;
+	return Table.States[static_cast<int32>(State)][static_cast<int32>(Component)];
+}
+
+void ItemCollisionProfile::Apply(UPrimitiveComponent* Component, const FItemComponentProfile& Profile)
+{
+	if (Component == nullptr) return;
+
+	// physics has to stop before the collision settings underneath it change
+	if (!Profile.bSimulatePhysics && Component->IsSimulatingPhysics())
+	{
+		Component->SetSimulatePhysics(false);
+	}
+
+	const bool bEnabledChanged{ Component->GetCollisionEnabled() != Profile.CollisionEnabled };
+	if (bEnabledChanged || Component->GetCollisionResponseToChannels() != Profile.Responses)
+	{
+		// write the new type without a filter update, the response update below does one for both
+		Component->BodyInstance.SetCollisionEnabled(Profile.CollisionEnabled, false);
+		if (bEnabledChanged && Profile.CollisionEnabled != ECollisionEnabled::NoCollision && !Component->HasValidPhysicsState())
+		{
+			// a component registered without collision has no body yet
+			Component->RecreatePhysicsState();
+		}
+		Component->SetCollisionResponseToChannels(Profile.Responses);
+	}
+
+	if (Component->IsGravityEnabled() != Profile.bEnableGravity)
+	{
+		Component->SetEnableGravity(Profile.bEnableGravity);
+	}
+	if (Profile.bSimulatePhysics && !Component->IsSimulatingPhysics())
+	{
+		Component->SetSimulatePhysics(true);
+	}
+	if (Component->IsVisible() != Profile.bVisible)
+	{
+		Component->SetVisibility(Profile.bVisible);
+	}
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Item.h"
+
+class UPrimitiveComponent;
+
+// The item components whose settings change with the item state
+enum class EItemComponent : uint8
+{
+	Mesh,
+	AreaSphere,
+	CollisionBox,
+
+	Max
+};
+
+// Physics, collision and visibility of one item component in one item state
+struct FItemComponentProfile
+{
+	ECollisionEnabled::Type CollisionEnabled{ ECollisionEnabled::NoCollision };
+	FCollisionResponseContainer Responses{ ECR_Ignore };
+	bool bSimulatePhysics{ false };
+	bool bEnableGravity{ false };
+	bool bVisible{ true };
+};
+
+/**
+ * Precomputed component settings for every item state.
+ * Applying a profile only touches what differs from the component's current settings,
+ * writes all channel responses at once and rebuilds the physics state at most once.
+ */
+namespace ItemCollisionProfile
+{
+	SHOOTER_API const FItemComponentProfile& Get(EItemState State, EItemComponent Component);
+
+	SHOOTER_API void Apply(UPrimitiveComponent* Component, const FItemComponentProfile& Profile);
+}
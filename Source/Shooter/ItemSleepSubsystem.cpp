@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemSleepSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Item.h"
+#include "Shooter.h"
+#include "ShooterTimings.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Items"), STAT_ActiveItems, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Sleeping Items"), STAT_SleepingItems, STATGROUP_Shooter);
+
+UItemSleepSubsystem::UItemSleepSubsystem() :
+	SleepDistance(6000.f),
+	WakeDistance(5000.f),
+	ChecksPerFrame(64),
+	NextCheck(0),
+	NumSleeping(0)
+{
+}
+
+void UItemSleepSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SHOOTER_SCOPE_TIMING(ItemSleep);
+
+	SET_DWORD_STAT(STAT_ActiveItems, GetNumActive());
+	SET_DWORD_STAT(STAT_SleepingItems, NumSleeping);
+	if (Items.Num() == 0) return;
+
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APawn* Pawn{ It->IsValid() ? (*It)->GetPawn() : nullptr };
+		if (Pawn)
+		{
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+	// no players, leave everything as it is
+	if (PlayerLocations.Num() == 0) return;
+
+	const float SleepDistanceSquared{ SleepDistance * SleepDistance };
+	const float WakeDistanceSquared{ FMath::Square(FMath::Min(WakeDistance, SleepDistance)) };
+
+	const int32 NumChecks{ FMath::Min(ChecksPerFrame, Items.Num()) };
+	for (int32 i = 0; i < NumChecks; i++)
+	{
+		if (NextCheck >= Items.Num())
+		{
+			NextCheck = 0;
+		}
+		AItem* Item{ Items[NextCheck++] };
+
+		const FVector ItemLocation{ Item->GetActorLocation() };
+		float ClosestSquared{ TNumericLimits<float>::Max() };
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			ClosestSquared = FMath::Min(ClosestSquared, static_cast<float>(FVector::DistSquared(ItemLocation, PlayerLocation)));
+		}
+
+		if (Item->IsAsleep())
+		{
+			if (ClosestSquared < WakeDistanceSquared)
+			{
+				Item->SetAsleep(false);
+				NumSleeping--;
+			}
+		}
+		else if (ClosestSquared > SleepDistanceSquared && Item->CanSleep())
+		{
+			Item->SetAsleep(true);
+			NumSleeping++;
+		}
+	}
+}
+
+TStatId UItemSleepSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemSleepSubsystem, STATGROUP_Tickables);
+}
+
+bool UItemSleepSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UItemSleepSubsystem::Register(AItem* Item)
+{
+	if (Item == nullptr || Item->GetSleepIndex() != INDEX_NONE) return;
+	Item->SetSleepIndex(Items.Add(Item));
+}
+
+void UItemSleepSubsystem::Unregister(AItem* Item)
+{
+	if (Item == nullptr) return;
+	const int32 Index{ Item->GetSleepIndex() };
+	if (!Items.IsValidIndex(Index) || Items[Index] != Item) return;
+
+	if (Item->IsAsleep())
+	{
+		NumSleeping--;
+	}
+	Item->SetSleepIndex(INDEX_NONE);
+
+	// the last item takes the freed slot
+	Items.RemoveAtSwap(Index, 1, false);
+	if (Index < Items.Num())
+	{
+		Items[Index]->SetSleepIndex(Index);
+	}
+}
+
+void UItemSleepSubsystem::Wake(AItem* Item)
+{
+	if (Item == nullptr || !Item->IsAsleep()) return;
+
+	Item->SetAsleep(false);
+	NumSleeping--;
+}
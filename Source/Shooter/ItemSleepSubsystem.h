@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ItemSleepSubsystem.generated.h"
+
+class AItem;
+
+/**
+ * Puts pickups far from every player to sleep and wakes them as a player approaches.
+ * Items are checked a slice at a time, with separate sleep and wake distances so an
+ * item on the boundary doesn't flip every check.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UItemSleepSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UItemSleepSubsystem();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	void Register(AItem* Item);
+	void Unregister(AItem* Item);
+
+	// Wake an item straight away, for when something other than a player approaching needs it awake
+	void Wake(AItem* Item);
+
+	FORCEINLINE int32 GetNumSleeping() const { return NumSleeping; }
+	FORCEINLINE int32 GetNumActive() const { return Items.Num() - NumSleeping; }
+
+private:
+
+	// Pickups further than this from every player go to sleep
+	UPROPERTY(Config)
+	float SleepDistance;
+
+	// Sleeping pickups closer than this to any player wake up, less than SleepDistance
+	UPROPERTY(Config)
+	float WakeDistance;
+
+	// Items checked per frame
+	UPROPERTY(Config)
+	int32 ChecksPerFrame;
+
+	// every item knows its index here, removal swaps the last item into the gap
+	TArray<AItem*> Items;
+
+	// next item to check, wraps around
+	int32 NextCheck;
+
+	int32 NumSleeping;
+};
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PickupInterpSubsystem.h"
+#include "Camera/CameraComponent.h"
+#include "Components/SceneComponent.h"
+#include "Misc/MemStack.h"
+#include "BakedCurve.h"
+#include "Item.h"
+#include "ShooterCharacter.h"
+#include "Shooter.h"
+#include "ShooterTimings.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Interp"), STAT_PickupInterp, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Interping Pickups"), STAT_InterpingPickups, STATGROUP_Shooter);
+
+namespace
+{
+	// Evaluate a per-item curve over runs of items sharing the same table, items without one get DefaultValue
+	template<typename GetTableType, typename AllocatorType>
+	void EvaluateRuns(
+		const TArray<AItem*, AllocatorType>& Items,
+		GetTableType GetTable,
+		TArrayView<const float> Times,
+		TArrayView<float> OutValues,
+		float DefaultValue)
+	{
+		int32 RunStart{ 0 };
+		while (RunStart < Items.Num())
+		{
+			const FBakedCurve* Table{ GetTable(Items[RunStart]) };
+			int32 RunEnd{ RunStart + 1 };
+			while (RunEnd < Items.Num() && GetTable(Items[RunEnd]) == Table)
+			{
+				RunEnd++;
+			}
+
+			const int32 RunLength{ RunEnd - RunStart };
+			if (Table)
+			{
+				Table->EvaluateBatch(Times.Slice(RunStart, RunLength), OutValues.Slice(RunStart, RunLength));
+			}
+			else
+			{
+				for (int32 i = RunStart; i < RunEnd; i++)
+				{
+					OutValues[i] = DefaultValue;
+				}
+			}
+			RunStart = RunEnd;
+		}
+	}
+}
+
+void UPickupInterpSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_PickupInterp);
+	SHOOTER_SCOPE_TIMING(PickupInterp);
+
+	Interps.RemoveAll([](const FPickupInterp& Interp) { return !Interp.Item.IsValid(); });
+	SET_DWORD_STAT(STAT_InterpingPickups, Interps.Num());
+	if (Interps.Num() == 0) return;
+
+	const float Now{ GetWorld()->GetTimeSeconds() };
+
+	FMemMark Mark(FMemStack::Get());
+	TArray<AItem*, TMemStackAllocator<>> Items;
+	TArray<float, TMemStackAllocator<>> Times;
+	Items.Reserve(Interps.Num());
+	Times.Reserve(Interps.Num());
+	for (const FPickupInterp& Interp : Interps)
+	{
+		Items.Add(Interp.Item.Get());
+		Times.Add(Now - Interp.StartTime);
+	}
+
+	TArray<float, TMemStackAllocator<>> ZValues;
+	TArray<float, TMemStackAllocator<>> Scales;
+	ZValues.SetNumUninitialized(Items.Num());
+	Scales.SetNumUninitialized(Items.Num());
+	EvaluateRuns(Items, [](const AItem* Item) { return Item->GetItemZTable(); }, Times, ZValues, 0.f);
+	EvaluateRuns(Items, [](const AItem* Item) { return Item->GetItemScaleTable(); }, Times, Scales, 1.f);
+
+	// camera and interp locations of the character the previous item flew to, almost always the only one
+	const AShooterCharacter* CachedCharacter{ nullptr };
+	float CameraYaw{ 0.f };
+	TArray<FVector, TMemStackAllocator<>> InterpLocations;
+
+	// Child, render and overlap updates of every moved item wait until all of them have moved, then each item
+	// flushes once. Reserved up front since every scope is referenced by its component and must not move
+	TArray<FScopedMovementUpdate, TMemStackAllocator<>> MovementUpdates;
+	MovementUpdates.Reserve(Items.Num());
+
+	for (int32 i = 0; i < Items.Num(); i++)
+	{
+		AItem* Item{ Items[i] };
+		const AShooterCharacter* Character{ Item->GetCharacter() };
+		if (Character == nullptr) continue;
+
+		if (Character != CachedCharacter)
+		{
+			CachedCharacter = Character;
+			const FTransform CameraTransform{ Character->GetFollowCamera()->GetComponentTransform() };
+			CameraYaw = CameraTransform.Rotator().Yaw;
+			InterpLocations.Reset();
+			for (const FInterpLocation& InterpLocation : Character->GetInterpLocations())
+			{
+				InterpLocations.Add(CameraTransform.TransformPositionNoScale(InterpLocation.Offset));
+			}
+		}
+
+		const int32 TargetIndex{ Item->GetInterpTargetIndex() };
+		if (!InterpLocations.IsValidIndex(TargetIndex)) continue;
+
+		MovementUpdates.Emplace(Item->GetRootComponent(), EScopedUpdate::DeferredUpdates);
+		Item->ApplyInterpFrame(InterpLocations[TargetIndex], CameraYaw, ZValues[i], Scales[i], DeltaTime);
+	}
+}
+
+TStatId UPickupInterpSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPickupInterpSubsystem, STATGROUP_Tickables);
+}
+
+bool UPickupInterpSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UPickupInterpSubsystem::Register(AItem* Item)
+{
+	if (Item == nullptr) return;
+	Unregister(Item);
+
+	FPickupInterp Interp;
+	Interp.Item = Item;
+	Interp.StartTime = GetWorld()->GetTimeSeconds();
+
+	// insert after the last item using the same Z curve
+	const FBakedCurve* ZTable{ Item->GetItemZTable() };
+	const int32 LastMatch{ Interps.FindLastByPredicate([ZTable](const FPickupInterp& Other)
+	{
+		return Other.Item.IsValid() && Other.Item->GetItemZTable() == ZTable;
+	}) };
+	Interps.Insert(Interp, LastMatch == INDEX_NONE ? Interps.Num() : LastMatch + 1);
+}
+
+void UPickupInterpSubsystem::Unregister(AItem* Item)
+{
+	Interps.RemoveAll([Item](const FPickupInterp& Interp) { return Interp.Item.Get() == Item; });
+}
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PickupInterpSubsystem.generated.h"
+
+class AItem;
+
+// An item flying from the ground to its character
+struct FPickupInterp
+{
+	TWeakObjectPtr<AItem> Item;
+	float StartTime{ 0.f };
+};
+
+/**
+ * Animates every item in the EquipInterping state in one pass.
+ * Curves are evaluated in batches, each character's camera and interp locations are read once per frame
+ * and every item gets a single unswept transform update inside a deferred movement scope, so attached
+ * components, render state and overlaps are brought up to date once per item after the whole batch has moved.
+ */
+UCLASS()
+class SHOOTER_API UPickupInterpSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Start animating an item, its interp timer still decides when it finishes
+	void Register(AItem* Item);
+	void Unregister(AItem* Item);
+
+private:
+
+	// items sharing a Z curve are kept next to each other so their curve is evaluated as one batch
+	TArray<FPickupInterp> Interps;
+};
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PickupWidget.h"
+#include "Item.h"
+
+void UPickupWidget::SetItem(AItem* NewItem)
+{
+	Item = NewItem;
+	if (Item)
+	{
+		ItemName = Item->GetItemName();
+		ItemCount = Item->GetItemCount();
+		LightColor = Item->GetLightColor();
+		DarkColor = Item->GetDarkColor();
+		ActiveStars = Item->GetActiveStars();
+		bCharacterInventoryFull = Item->IsCharacterInventoryFull();
+	}
+	else
+	{
+		ItemName.Reset();
+		ItemCount = 0;
+		ActiveStars.Reset();
+		bCharacterInventoryFull = false;
+	}
+	OnItemChanged();
+}
+
+void UPickupWidget::SetInventoryFull(bool bFull)
+{
+	if (bCharacterInventoryFull == bFull) return;
+
+	bCharacterInventoryFull = bFull;
+	OnItemChanged();
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "PickupWidget.generated.h"
+
+class AItem;
+
+/**
+ * Pickup popup shown over the item the player is looking at.
+ * The character owns one and fills it from whichever item has focus,
+ * so items no longer carry a widget component of their own.
+ */
+UCLASS(Abstract)
+class SHOOTER_API UPickupWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	// Copy the item's display data, null clears it
+	void SetItem(AItem* NewItem);
+
+	// Only the inventory full flag changes while an item keeps focus
+	void SetInventoryFull(bool bFull);
+
+	FORCEINLINE AItem* GetItem() const { return Item; }
+
+protected:
+	// Called after the displayed data changes
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnItemChanged();
+
+private:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pickup", meta = (AllowPrivateAccess = "true"))
+	AItem* Item;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pickup", meta = (AllowPrivateAccess = "true"))
+	FString ItemName;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pickup", meta = (AllowPrivateAccess = "true"))
+	int32 ItemCount;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pickup", meta = (AllowPrivateAccess = "true"))
+	FLinearColor LightColor;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pickup", meta = (AllowPrivateAccess = "true"))
+	FLinearColor DarkColor;
+
+	// the 0 element is NOT used, same as AItem
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pickup", meta = (AllowPrivateAccess = "true"))
+	TArray<bool> ActiveStars;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pickup", meta = (AllowPrivateAccess = "true"))
+	bool bCharacterInventoryFull;
+};
@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ProjectileSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Misc/MemStack.h"
+#include "ShooterCharacter.h"
+#include "Shooter.h"
+#include "ShooterTimings.h"
+#include "TraceSchedulerSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile Tick"), STAT_ProjectileTick, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bullets In Flight"), STAT_BulletsInFlight, STATGROUP_Shooter);
+
+UProjectileSubsystem::UProjectileSubsystem() :
+	MaxBullets(4096),
+	BulletLifetime(3.f),
+	MaxSubstepTime(1.f / 120.f),
+	MaxSubsteps(4),
+	MinBulletsForParallel(64)
+{
+}
+
+void UProjectileSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileTick);
+	SHOOTER_SCOPE_TIMING(Projectiles);
+
+	if (Positions.Num() > 0)
+	{
+		AdvanceBullets(DeltaTime);
+		SweepBullets();
+	}
+
+	SET_DWORD_STAT(STAT_BulletsInFlight, Positions.Num());
+}
+
+TStatId UProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSubsystem, STATGROUP_Tickables);
+}
+
+bool UProjectileSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UProjectileSubsystem::FireBullet(const FProjectileSpawnParams& Params)
+{
+	if (Positions.Num() >= MaxBullets) return false;
+	if (Params.Velocity.IsNearlyZero()) return false;
+
+	Positions.Add(Params.Origin);
+	PreviousPositions.Add(Params.Origin);
+	Velocities.Add(Params.Velocity);
+	GravityScales.Add(Params.GravityScale);
+	Drags.Add(Params.Drag);
+	Ages.Add(0.f);
+	Damages.Add(Params.Damage);
+	HeadshotDamages.Add(Params.HeadshotDamage);
+	Shooters.Add(Params.Shooter);
+	return true;
+}
+
+void UProjectileSubsystem::AdvanceBullets(float DeltaTime)
+{
+	// split the frame into equal substeps no larger than MaxSubstepTime
+	const int32 NumSubsteps{ FMath::Clamp(FMath::CeilToInt(DeltaTime / MaxSubstepTime), 1, MaxSubsteps) };
+	const float StepTime{ DeltaTime / NumSubsteps };
+	const FVector Gravity{ 0.f, 0.f, GetWorld()->GetGravityZ() };
+
+	auto AdvanceBullet = [this, NumSubsteps, StepTime, DeltaTime, &Gravity](int32 Index)
+	{
+		FVector Position{ Positions[Index] };
+		FVector Velocity{ Velocities[Index] };
+		const FVector BulletGravity{ Gravity * GravityScales[Index] };
+		const float Drag{ Drags[Index] };
+
+		for (int32 Step = 0; Step < NumSubsteps; Step++)
+		{
+			// semi-implicit Euler: drag opposes velocity and grows with speed squared
+			const FVector Acceleration{ BulletGravity - Velocity * (Velocity.Size() * Drag) };
+			Velocity += Acceleration * StepTime;
+			Position += Velocity * StepTime;
+		}
+
+		PreviousPositions[Index] = Positions[Index];
+		Positions[Index] = Position;
+		Velocities[Index] = Velocity;
+		Ages[Index] += DeltaTime;
+	};
+
+	const int32 NumBullets{ Positions.Num() };
+	ParallelFor(NumBullets, AdvanceBullet, NumBullets < MinBulletsForParallel);
+}
+
+void UProjectileSubsystem::SweepBullets()
+{
+	// The batch below runs scene queries from worker threads. That is only safe while the game thread
+	// waits inside ParallelFor: nothing moves or registers components, GC can't start and the physics
+	// scene isn't written (scene queries take its read lock themselves). Workers never touch UObjects
+	// beyond the world and the actors resolved up front.
+	check(IsInGameThread());
+
+	const int32 NumBullets{ Positions.Num() };
+
+	// trace results only live for this call, take them from the frame arena
+	FMemMark Mark(FMemStack::Get());
+	TArray<FHitResult, TMemStackAllocator<>> SweepHits;
+	SweepHits.SetNum(NumBullets);
+
+	// weak pointers are resolved here, never on a worker
+	TArray<const AActor*, TMemStackAllocator<>> IgnoredActors;
+	IgnoredActors.SetNumUninitialized(NumBullets);
+	for (int32 Index = 0; Index < NumBullets; Index++)
+	{
+		IgnoredActors[Index] = Shooters[Index].Get();
+	}
+
+	// Trace the whole batch; the path of a bullet this frame is approximated by one segment
+	const UWorld* World{ GetWorld() };
+	ParallelFor(NumBullets, [this, World, &SweepHits, &IgnoredActors](int32 Index)
+	{
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BulletSweep), false, IgnoredActors[Index]);
+		World->LineTraceSingleByChannel(
+			SweepHits[Index],
+			PreviousPositions[Index],
+			Positions[Index],
+			ECollisionChannel::ECC_Visibility,
+			QueryParams);
+	}, NumBullets < MinBulletsForParallel);
+	UTraceSchedulerSubsystem::AddTraces(this, ETraceCategory::Combat, NumBullets);
+
+	// Resolve hits on the game thread. Walk backwards so removals don't skip bullets
+	for (int32 Index = NumBullets - 1; Index >= 0; Index--)
+	{
+		const FHitResult& Hit{ SweepHits[Index] };
+		if (Hit.bBlockingHit)
+		{
+			if (AShooterCharacter* Shooter = Shooters[Index].Get())
+			{
+				Shooter->ApplyBulletHit(Hit, Damages[Index], HeadshotDamages[Index]);
+			}
+			RemoveBullet(Index);
+		}
+		else if (Ages[Index] >= BulletLifetime)
+		{
+			RemoveBullet(Index);
+		}
+	}
+}
+
+void UProjectileSubsystem::RemoveBullet(int32 Index)
+{
+	// swap with the last bullet so every array stays packed
+	Positions.RemoveAtSwap(Index, 1, false);
+	PreviousPositions.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	GravityScales.RemoveAtSwap(Index, 1, false);
+	Drags.RemoveAtSwap(Index, 1, false);
+	Ages.RemoveAtSwap(Index, 1, false);
+	Damages.RemoveAtSwap(Index, 1, false);
+	HeadshotDamages.RemoveAtSwap(Index, 1, false);
+	Shooters.RemoveAtSwap(Index, 1, false);
+}
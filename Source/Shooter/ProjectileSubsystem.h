@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProjectileSubsystem.generated.h"
+
+// Everything needed to put a new simulated bullet in flight
+struct FProjectileSpawnParams
+{
+	// Character that fired the bullet, receives the hit callback
+	class AShooterCharacter* Shooter{ nullptr };
+
+	FVector Origin{ FVector::ZeroVector };
+	FVector Velocity{ FVector::ZeroVector };
+
+	// Multiplier applied to world gravity
+	float GravityScale{ 1.f };
+
+	// Quadratic drag coefficient, deceleration = Drag * Speed^2
+	float Drag{ 0.f };
+
+	float Damage{ 0.f };
+	float HeadshotDamage{ 0.f };
+};
+
+/**
+ * Simulates bullets for weapons that don't use hitscan.
+ * Bullets live in flat arrays (one per attribute) instead of one actor per bullet,
+ * are integrated in parallel with substepping and swept with one batch of traces per frame.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UProjectileSubsystem();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Adds a bullet to the simulation. Returns false if the buffer is full
+	bool FireBullet(const FProjectileSpawnParams& Params);
+
+	FORCEINLINE int32 GetNumBullets() const { return Positions.Num(); }
+
+private:
+
+	// Integrate every bullet forward by DeltaTime, split into substeps
+	void AdvanceBullets(float DeltaTime);
+
+	// Trace every bullet's path for this frame and resolve the hits
+	void SweepBullets();
+
+	void RemoveBullet(int32 Index);
+
+	// Max bullets in flight, further shots are dropped
+	UPROPERTY(Config)
+	int32 MaxBullets;
+
+	// Bullets are removed after this many seconds in flight
+	UPROPERTY(Config)
+	float BulletLifetime;
+
+	// Largest time step used when integrating a bullet
+	UPROPERTY(Config)
+	float MaxSubstepTime;
+
+	// Upper bound on substeps per frame, so a hitch doesn't snowball
+	UPROPERTY(Config)
+	int32 MaxSubsteps;
+
+	// Bullets run through the ParallelFor path only above this count
+	UPROPERTY(Config)
+	int32 MinBulletsForParallel;
+
+	// Bullet state, one entry per bullet in every array
+	TArray<FVector> Positions;
+	TArray<FVector> PreviousPositions;
+	TArray<FVector> Velocities;
+	TArray<float> GravityScales;
+	TArray<float> Drags;
+	TArray<float> Ages;
+	TArray<float> Damages;
+	TArray<float> HeadshotDamages;
+	TArray<TWeakObjectPtr<AShooterCharacter>> Shooters;
+};
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RandomStreamSubsystem.h"
+#include "Engine/World.h"
+#include "Misc/CommandLine.h"
+
+uint32 FCounterRandom::GetUInt(uint32 Key, uint32 Counter) const
+{
+	// splitmix64 finalizer over key, counter and seed
+	uint64 X{ ((static_cast<uint64>(Key) << 32) | Counter) + static_cast<uint64>(Seed) * 0x9E3779B97F4A7C15ull };
+	X = (X ^ (X >> 30)) * 0xBF58476D1CE4E5B9ull;
+	X = (X ^ (X >> 27)) * 0x94D049BB133111EBull;
+	return static_cast<uint32>((X ^ (X >> 31)) >> 32);
+}
+
+void FCounterRandom::GetFractions(TArrayView<const uint32> Keys, uint32 Counter, TArrayView<float> OutValues) const
+{
+	check(Keys.Num() == OutValues.Num());
+	for (int32 i = 0; i < Keys.Num(); i++)
+	{
+		OutValues[i] = GetFraction(Keys[i], Counter);
+	}
+}
+
+bool URandomStreamSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URandomStreamSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	int32 Seed{ 0 };
+	if (!FParse::Value(FCommandLine::Get(), TEXT("ShooterSeed="), Seed))
+	{
+		Seed = static_cast<int32>(FPlatformTime::Cycles());
+	}
+	SetSessionSeed(Seed);
+}
+
+void URandomStreamSubsystem::SetSessionSeed(int32 Seed)
+{
+	SessionSeed = Seed;
+	NextKey = 0;
+
+	// each stream gets its own seed derived from the session seed
+	const FCounterRandom Derive{ static_cast<uint32>(Seed) };
+	for (int32 i = 0; i < static_cast<int32>(ERandomStream::Max); i++)
+	{
+		CounterRandoms[i].Seed = Derive.GetUInt(i, 0);
+	}
+}
+
+FCounterRandom URandomStreamSubsystem::Get(const UObject* WorldContext, ERandomStream Stream)
+{
+	const UWorld* World{ WorldContext ? WorldContext->GetWorld() : nullptr };
+	const URandomStreamSubsystem* Subsystem{ World ? World->GetSubsystem<URandomStreamSubsystem>() : nullptr };
+	return Subsystem ? Subsystem->GetCounterRandom(Stream) : FCounterRandom{};
+}
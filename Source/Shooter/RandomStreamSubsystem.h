@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RandomStreamSubsystem.generated.h"
+
+// Independent random sequences, one per gameplay system so rolls in one don't shift the others
+enum class ERandomStream : uint8
+{
+	Combat,
+	AI,
+
+	Max
+};
+
+// An entity's own position in a counter based stream
+struct FRandomCounter
+{
+	uint32 Key{ 0 };
+	uint32 Counter{ 0 };
+};
+
+/**
+ * Counter based generator: the value for (Key, Counter) is a hash, not the next step of a sequence.
+ * Give every entity its own key and counter and its rolls no longer depend on the order entities
+ * are processed in, so batches can be rolled on any number of threads.
+ */
+struct SHOOTER_API FCounterRandom
+{
+	uint32 Seed{ 0 };
+
+	uint32 GetUInt(uint32 Key, uint32 Counter) const;
+
+	// In [0, 1)
+	FORCEINLINE float GetFraction(uint32 Key, uint32 Counter) const
+	{
+		return (GetUInt(Key, Counter) >> 8) * (1.f / 16777216.f);
+	}
+
+	FORCEINLINE float FRandRange(uint32 Key, uint32 Counter, float Min, float Max) const
+	{
+		return Min + (Max - Min) * GetFraction(Key, Counter);
+	}
+
+	// Inclusive on both ends like FMath::RandRange
+	FORCEINLINE int32 RandRange(uint32 Key, uint32 Counter, int32 Min, int32 Max) const
+	{
+		const int32 Range{ Max - Min + 1 };
+		return Min + FMath::Min(static_cast<int32>(GetFraction(Key, Counter) * Range), Range - 1);
+	}
+
+	// Next roll for an entity, advancing its counter
+	FORCEINLINE float FRand(FRandomCounter& InCounter) const { return GetFraction(InCounter.Key, InCounter.Counter++); }
+	FORCEINLINE float FRandRange(FRandomCounter& InCounter, float Min, float Max) const { return FRandRange(InCounter.Key, InCounter.Counter++, Min, Max); }
+	FORCEINLINE int32 RandRange(FRandomCounter& InCounter, int32 Min, int32 Max) const { return RandRange(InCounter.Key, InCounter.Counter++, Min, Max); }
+
+	// Fractions for a batch of keys sharing one counter, safe to split across threads
+	void GetFractions(TArrayView<const uint32> Keys, uint32 Counter, TArrayView<float> OutValues) const;
+};
+
+/**
+ * Owns the session seed and the per system generators derived from it.
+ * The seed comes from -ShooterSeed=N, a replay header, or the clock.
+ */
+UCLASS()
+class SHOOTER_API URandomStreamSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// Reseeds every stream, only meaningful before gameplay starts rolling
+	void SetSessionSeed(int32 Seed);
+	FORCEINLINE int32 GetSessionSeed() const { return SessionSeed; }
+
+	FORCEINLINE const FCounterRandom& GetCounterRandom(ERandomStream Stream) const { return CounterRandoms[static_cast<int32>(Stream)]; }
+
+	// Keys are handed out in registration order, which is deterministic as long as spawning is
+	FRandomCounter AllocateCounter() { return FRandomCounter{ NextKey++, 0 }; }
+
+	// Generator for a stream of WorldContext's world, unseeded outside of game worlds
+	static FCounterRandom Get(const UObject* WorldContext, ERandomStream Stream);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	int32 SessionSeed{ 0 };
+	uint32 NextKey{ 0 };
+
+	FCounterRandom CounterRandoms[static_cast<int32>(ERandomStream::Max)];
+};
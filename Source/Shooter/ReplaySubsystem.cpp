@@ -0,0 +1,308 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ReplaySubsystem.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "Item.h"
+#include "RandomStreamSubsystem.h"
+#include "ShooterCharacter.h"
+#include "ShooterTimings.h"
+
+namespace
+{
+	FString GetReplayPath(const FString& Name, const TCHAR* Extension)
+	{
+		return FPaths::ProjectSavedDir() / TEXT("Replays") / Name + Extension;
+	}
+
+	void WriteCsvLine(FArchive& Ar, const FString& Line)
+	{
+		const FTCHARToUTF8 Utf8{ *(Line + LINE_TERMINATOR) };
+		Ar.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+	}
+
+	// Spawns that matter for gameplay, effects and the like are left out
+	bool ShouldTrackSpawn(const AActor* Actor)
+	{
+		return Actor && (Actor->IsA<APawn>() || Actor->IsA<AItem>());
+	}
+}
+
+bool UReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// runs before any actor's BeginPlay so the seed covers everything gameplay rolls
+	FString Name;
+	bool bStarted{ false };
+	if (FParse::Value(FCommandLine::Get(), TEXT("ShooterReplay="), Name))
+	{
+		bStarted = StartPlayback(Name);
+	}
+	else if (FParse::Param(FCommandLine::Get(), TEXT("ShooterRecord")))
+	{
+		if (!FParse::Value(FCommandLine::Get(), TEXT("ShooterRecord="), Name))
+		{
+			Name = FDateTime::Now().ToString();
+		}
+		bStarted = StartRecording(Name);
+	}
+	if (!bStarted) return;
+
+	// gameplay rolls go through the random streams, the global RNGs cover engine and blueprint randomness
+	if (URandomStreamSubsystem* Random = InWorld.GetSubsystem<URandomStreamSubsystem>())
+	{
+		Random->SetSessionSeed(Header.Seed);
+	}
+	FMath::RandInit(Header.Seed);
+	FMath::SRandInit(Header.Seed);
+
+	TimingWriter.Reset(IFileManager::Get().CreateFileWriter(*GetReplayPath(Name, TEXT(".csv"))));
+	if (TimingWriter)
+	{
+		WriteCsvLine(*TimingWriter, FShooterTimings::GetCsvHeader());
+	}
+
+	PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &UReplaySubsystem::OnPreActorTick);
+	ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UReplaySubsystem::OnActorSpawned));
+}
+
+void UReplaySubsystem::Deinitialize()
+{
+	Stop();
+	Super::Deinitialize();
+}
+
+bool UReplaySubsystem::StartRecording(const FString& Name)
+{
+	const FString Path{ GetReplayPath(Name, TEXT(".replay")) };
+	ReplayWriter.Reset(IFileManager::Get().CreateFileWriter(*Path));
+	if (!ReplayWriter)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not create replay %s"), *Path);
+		return false;
+	}
+
+	const URandomStreamSubsystem* Random{ GetWorld()->GetSubsystem<URandomStreamSubsystem>() };
+	Header.Seed = Random ? Random->GetSessionSeed() : static_cast<int32>(FPlatformTime::Cycles());
+	Header.MapName = GetWorld()->GetMapName();
+	*ReplayWriter << Header;
+	return true;
+}
+
+bool UReplaySubsystem::StartPlayback(const FString& Name)
+{
+	const FString Path{ GetReplayPath(Name, TEXT(".replay")) };
+	ReplayReader.Reset(IFileManager::Get().CreateFileReader(*Path));
+	if (!ReplayReader)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not open replay %s"), *Path);
+		return false;
+	}
+
+	*ReplayReader << Header;
+	if (ReplayReader->IsError() || Header.Magic != ShooterReplay::Magic || Header.Version != ShooterReplay::Version)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s is not a version %u replay"), *Path, ShooterReplay::Version);
+		ReplayReader.Reset();
+		return false;
+	}
+	if (Header.MapName != GetWorld()->GetMapName())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Replay %s was recorded on %s, playing on %s"), *Name, *Header.MapName, *GetWorld()->GetMapName());
+	}
+
+	// frame times come from the replay from now on
+	bHasNextFrame = ReadNextFrame();
+	FApp::SetUseFixedTimeStep(true);
+	if (bHasNextFrame)
+	{
+		FApp::SetFixedDeltaTime(NextFrame.DeltaTime);
+	}
+	return true;
+}
+
+void UReplaySubsystem::Stop()
+{
+	if (IsPlaying())
+	{
+		FApp::SetUseFixedTimeStep(false);
+		if (AShooterCharacter* Character = InputDisabledCharacter.Get())
+		{
+			Character->EnableInput(Cast<APlayerController>(Character->GetController()));
+		}
+	}
+
+	ReplayWriter.Reset();
+	ReplayReader.Reset();
+	TimingWriter.Reset();
+	InputDisabledCharacter.Reset();
+
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+	PreActorTickHandle.Reset();
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+	ActorSpawnedHandle.Reset();
+}
+
+void UReplaySubsystem::RecordAction(uint8 Action, bool bPressed)
+{
+	if (!IsRecording()) return;
+	CurrentFrame.Actions.Add(FReplayActionEvent{ Action, bPressed });
+}
+
+void UReplaySubsystem::OnPreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld != GetWorld()) return;
+
+	AShooterCharacter* Character{ GetPlayerCharacter() };
+
+	if (IsRecording())
+	{
+		if (FrameNumber > 0)
+		{
+			CloseRecordedFrame(Character);
+			WriteTimingRow();
+		}
+		CurrentFrame.Reset();
+		CurrentFrame.DeltaTime = DeltaSeconds;
+		FrameNumber++;
+		return;
+	}
+
+	if (!IsPlaying()) return;
+
+	if (FrameNumber > 0)
+	{
+		CheckPlaybackSpawns();
+		WriteTimingRow();
+	}
+	else
+	{
+		// recording drops whatever spawned before its first frame (BeginPlay's default weapon), so drop it here too
+		PlaybackSpawns.Reset();
+	}
+
+	if (!bHasNextFrame)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Replay finished after %u frames, %u diverged"), FrameNumber, NumDivergentFrames);
+		const bool bExit{ InWorld->WorldType == EWorldType::Game };
+		Stop();
+		if (bExit)
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+		return;
+	}
+
+	CurrentFrame = MoveTemp(NextFrame);
+	bHasNextFrame = ReadNextFrame();
+	if (bHasNextFrame)
+	{
+		FApp::SetFixedDeltaTime(NextFrame.DeltaTime);
+	}
+	FrameNumber++;
+
+	if (Character == nullptr) return;
+	if (InputDisabledCharacter.Get() != Character)
+	{
+		// the replay is the only input
+		Character->DisableInput(Cast<APlayerController>(Character->GetController()));
+		InputDisabledCharacter = Character;
+	}
+
+	for (int32 i = 0; i < static_cast<int32>(EReplayAxis::Max); i++)
+	{
+		Character->ApplyReplayAxis(static_cast<EReplayAxis>(i), CurrentFrame.Axes[i]);
+	}
+	for (const FReplayActionEvent& Event : CurrentFrame.Actions)
+	{
+		Character->InputAction(Event.Action, Event.bPressed);
+	}
+}
+
+void UReplaySubsystem::OnActorSpawned(AActor* Actor)
+{
+	if (!ShouldTrackSpawn(Actor)) return;
+
+	FReplaySpawnEvent Spawn{ Actor->GetClass()->GetPathName(), FVector3f(Actor->GetActorLocation()) };
+	if (IsRecording())
+	{
+		CurrentFrame.Spawns.Add(MoveTemp(Spawn));
+	}
+	else if (IsPlaying())
+	{
+		PlaybackSpawns.Add(MoveTemp(Spawn));
+	}
+}
+
+void UReplaySubsystem::CloseRecordedFrame(AShooterCharacter* Character)
+{
+	// axis values processed during the frame that just ended
+	const UInputComponent* Input{ Character ? Character->InputComponent.Get() : nullptr };
+	if (Input)
+	{
+		for (int32 i = 0; i < static_cast<int32>(EReplayAxis::Max); i++)
+		{
+			CurrentFrame.Axes[i] = Input->GetAxisValue(ShooterReplay::GetAxisName(static_cast<EReplayAxis>(i)));
+		}
+	}
+	*ReplayWriter << CurrentFrame;
+}
+
+void UReplaySubsystem::CheckPlaybackSpawns()
+{
+	bool bDiverged{ PlaybackSpawns.Num() != CurrentFrame.Spawns.Num() };
+	for (int32 i = 0; !bDiverged && i < PlaybackSpawns.Num(); i++)
+	{
+		const FReplaySpawnEvent& Expected{ CurrentFrame.Spawns[i] };
+		const FReplaySpawnEvent& Actual{ PlaybackSpawns[i] };
+		bDiverged = Expected.ClassPath != Actual.ClassPath || !Expected.Location.Equals(Actual.Location, 1.f);
+	}
+
+	if (bDiverged)
+	{
+		// only the first one is interesting, everything after it follows from it
+		if (NumDivergentFrames == 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Replay diverged at frame %u: recorded %d spawns, played back %d"),
+				FrameNumber, CurrentFrame.Spawns.Num(), PlaybackSpawns.Num());
+		}
+		NumDivergentFrames++;
+	}
+	PlaybackSpawns.Reset();
+}
+
+bool UReplaySubsystem::ReadNextFrame()
+{
+	if (ReplayReader->AtEnd()) return false;
+	*ReplayReader << NextFrame;
+	return !ReplayReader->IsError();
+}
+
+void UReplaySubsystem::WriteTimingRow()
+{
+	const FString Row{ FShooterTimings::ConsumeCsvRow(FrameNumber - 1, CurrentFrame.DeltaTime) };
+	if (TimingWriter)
+	{
+		WriteCsvLine(*TimingWriter, Row);
+	}
+}
+
+AShooterCharacter* UReplaySubsystem::GetPlayerCharacter() const
+{
+	return Cast<AShooterCharacter>(UGameplayStatics::GetPlayerCharacter(GetWorld(), 0));
+}
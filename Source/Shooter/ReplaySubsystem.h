@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterReplay.h"
+#include "ReplaySubsystem.generated.h"
+
+class AShooterCharacter;
+
+/**
+ * Records the local player's input and frame times, and plays them back so a session can be re-run
+ * for profiling and regression checks.
+ * -ShooterRecord[=Name] records, -ShooterReplay=Name plays back. Files live in Saved/Replays and are
+ * streamed a frame at a time. Both modes also write Name.csv with the per subsystem timings.
+ * Frames run from one pre actor tick to the next so input, spawns and timings share the same boundaries.
+ */
+UCLASS()
+class SHOOTER_API UReplaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Called by the character for every bound action
+	void RecordAction(uint8 Action, bool bPressed);
+
+	FORCEINLINE bool IsRecording() const { return ReplayWriter.IsValid(); }
+	FORCEINLINE bool IsPlaying() const { return ReplayReader.IsValid(); }
+
+	// Seed of this session, recorded in or read from the replay header
+	FORCEINLINE int32 GetSeed() const { return Header.Seed; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	bool StartRecording(const FString& Name);
+	bool StartPlayback(const FString& Name);
+	void Stop();
+
+	void OnPreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void OnActorSpawned(AActor* Actor);
+
+	void CloseRecordedFrame(AShooterCharacter* Character);
+	void CheckPlaybackSpawns();
+
+	// Reads the frame after the current one, false at the end of the replay
+	bool ReadNextFrame();
+
+	void WriteTimingRow();
+
+	AShooterCharacter* GetPlayerCharacter() const;
+
+	TUniquePtr<FArchive> ReplayWriter;
+	TUniquePtr<FArchive> ReplayReader;
+	TUniquePtr<FArchive> TimingWriter;
+
+	FReplayHeader Header;
+
+	// recording: input gathered this frame, playback: the frame being replayed
+	FReplayFrame CurrentFrame;
+	// playback only, read ahead so its delta time can be fixed before the engine starts it
+	FReplayFrame NextFrame;
+	bool bHasNextFrame{ false };
+
+	// spawns seen during the current frame of playback
+	TArray<FReplaySpawnEvent> PlaybackSpawns;
+
+	uint32 FrameNumber{ 0 };
+	uint32 NumDivergentFrames{ 0 };
+
+	TWeakObjectPtr<AShooterCharacter> InputDisabledCharacter;
+
+	FDelegateHandle PreActorTickHandle;
+	FDelegateHandle ActorSpawnedHandle;
+};
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ScheduledBehaviorTreeComponent.h"
+#include "Engine/World.h"
+#include "AISchedulerSubsystem.h"
+
+UScheduledBehaviorTreeComponent::UScheduledBehaviorTreeComponent(const FObjectInitializer& ObjectInitializer) :
+	Super(ObjectInitializer),
+	bWantsTick(false),
+	LastScheduledTime(0.f)
+{
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void UScheduledBehaviorTreeComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UAISchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UAISchedulerSubsystem>())
+	{
+		Scheduler->Register(this);
+	}
+}
+
+void UScheduledBehaviorTreeComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UAISchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UAISchedulerSubsystem>())
+	{
+		Scheduler->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UScheduledBehaviorTreeComponent::SetComponentTickEnabled(bool bEnabled)
+{
+	bWantsTick = bEnabled;
+
+	// without a scheduler, e.g. in editor worlds, tick the usual way
+	if (!HasScheduler())
+	{
+		Super::SetComponentTickEnabled(bEnabled);
+	}
+}
+
+bool UScheduledBehaviorTreeComponent::IsComponentTickEnabled() const
+{
+	return HasScheduler() ? bWantsTick : Super::IsComponentTickEnabled();
+}
+
+void UScheduledBehaviorTreeComponent::ScheduledTick(float Now)
+{
+	const float DeltaTime{ Now - LastScheduledTime };
+	LastScheduledTime = Now;
+	TickComponent(DeltaTime, LEVELTICK_All, &PrimaryComponentTick);
+}
+
+bool UScheduledBehaviorTreeComponent::HasScheduler() const
+{
+	const UWorld* World{ GetWorld() };
+	return World && World->GetSubsystem<UAISchedulerSubsystem>();
+}
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "ScheduledBehaviorTreeComponent.generated.h"
+
+/**
+ * Behavior tree component ticked by the AI scheduler instead of the tick manager.
+ * The tree still decides whether it needs ticking at all, the scheduler decides when.
+ */
+UCLASS()
+class SHOOTER_API UScheduledBehaviorTreeComponent : public UBehaviorTreeComponent
+{
+	GENERATED_BODY()
+
+public:
+	UScheduledBehaviorTreeComponent(const FObjectInitializer& ObjectInitializer);
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// The tree turns its tick on and off as it needs it, the engine tick stays off and the scheduler reads the request
+	virtual void SetComponentTickEnabled(bool bEnabled) override;
+
+	// Reports the request rather than the engine tick, or the tree never asks to stop ticking
+	virtual bool IsComponentTickEnabled() const override;
+
+	// Called by the AI scheduler, ticks with the time since the last scheduled tick
+	void ScheduledTick(float Now);
+
+	FORCEINLINE bool WantsTick() const { return bWantsTick; }
+
+	// World time the scheduler last ticked or skipped this tree
+	FORCEINLINE float GetLastScheduledTime() const { return LastScheduledTime; }
+	FORCEINLINE void SetLastScheduledTime(float Time) { LastScheduledTime = Time; }
+
+private:
+
+	bool HasScheduler() const;
+
+	bool bWantsTick;
+
+	float LastScheduledTime;
+};
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
 
 #define EPS_Metal EPhysicalSurface::SurfaceType1
 #define EPS_Stone EPhysicalSurface::SurfaceType2
@@ -10,4 +11,4 @@
 #define EPS_Grass EPhysicalSurface::SurfaceType4
 #define EPS_Water EPhysicalSurface::SurfaceType5
 
-
+DECLARE_STATS_GROUP(TEXT("Shooter"), STATGROUP_Shooter, STATCAT_Advanced);
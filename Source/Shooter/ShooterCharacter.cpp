@@ -23,6 +23,14 @@
 #include "Enemy.h"
 #include "EnemyController.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "ProjectileSubsystem.h"
+#include "DamageQueueSubsystem.h"
+#include "DamageableGridSubsystem.h"
+#include "InventoryComponent.h"
+#include "AmmoLedgerComponent.h"
+#include "PickupWidget.h"
+#include "ReplaySubsystem.h"
+#include "ShooterSnapshot.h"
 
 
 
@@ -62,13 +70,15 @@ AShooterCharacter::AShooterCharacter() :
 	bFireButtonPressed(false),
 	// Item Trace Variables
 	bShouldTraceForItems(false),
+	ItemTraceDeadlineTime(0.f),
 	OverlappedItemCount(0),
+	PickupWidgetHeight(40.f),
 	// Camera Interp location variables
 	CameraInterpDistance(250.f),
 	CamerainterpElevation(65.f),
-	//Starting Ammo amounts
-	Starting9mmAmmo(85),
-	StartingARAmmo(50),
+	NumInterpAnchors(6),
+	ItemInterpDistance(200.f),
+	ItemInterpRadius(60.f),
 	// Combat Variables
 	CombatState(ECombatState::ECS_Unoccupied),
 	bCrouching(false),
@@ -86,12 +96,14 @@ AShooterCharacter::AShooterCharacter() :
 	EquipSoundResetTime(0.2f),
 	// Icon Animation property
 	HighlightedSlot(-1),
+	NumSlotKeys(6),
 	//char health
 	Health(100.f),
 	MaxHealth(100.f),
 	// stun chance
 	StunChance(0.25f),
-	bDead(false)
+	bDead(false),
+	MaxBulletSegments(4)
 	
 {
 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
@@ -120,30 +132,48 @@ AShooterCharacter::AShooterCharacter() :
 	GetCharacterMovement()->JumpZVelocity = 600.f;
 	GetCharacterMovement()->AirControl = 0.2f;
 	
+	Inventory = CreateDefaultSubobject<UInventoryComponent>(TEXT("Inventory"));
+	AmmoLedger = CreateDefaultSubobject<UAmmoLedgerComponent>(TEXT("AmmoLedger"));
+
 	// create hand scene component
 	HandSceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("HandSceneComp"));
 
-	// Create Interpolation Components
-	WeaponInterpComp = CreateDefaultSubobject<USceneComponent>(TEXT("Weapon Interpolation Component"));
-	WeaponInterpComp->SetupAttachment(GetFollowCamera());
-
-	InterpComp1 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 1"));
-	InterpComp1->SetupAttachment(GetFollowCamera());
-
-	InterpComp2 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 2"));
-	InterpComp2->SetupAttachment(GetFollowCamera());
-
-	InterpComp3 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 3"));
-	InterpComp3->SetupAttachment(GetFollowCamera());
+	// one pickup widget for every item, placed in world space over the focused item
+	PickupWidgetComponent = CreateDefaultSubobject<UWidgetComponent>(TEXT("PickupWidget"));
+	PickupWidgetComponent->SetupAttachment(GetRootComponent());
+	PickupWidgetComponent->SetUsingAbsoluteLocation(true);
+	PickupWidgetComponent->SetUsingAbsoluteRotation(true);
+	PickupWidgetComponent->SetWidgetSpace(EWidgetSpace::Screen);
+	PickupWidgetComponent->SetDrawAtDesiredSize(true);
+	PickupWidgetComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	PickupWidgetComponent->SetVisibility(false);
 
-	InterpComp4 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 4"));
-	InterpComp4->SetupAttachment(GetFollowCamera());
+#if WITH_EDITORONLY_DATA
+	// only assets saved with an override of the old defaults load a value here
+	Starting9mmAmmo_DEPRECATED = INDEX_NONE;
+	StartingARAmmo_DEPRECATED = INDEX_NONE;
+#endif
+}
 
-	InterpComp5 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 5"));
-	InterpComp5->SetupAttachment(GetFollowCamera());
+void AShooterCharacter::PostLoad()
+{
+	Super::PostLoad();
 
-	InterpComp6 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 6"));
-	InterpComp6->SetupAttachment(GetFollowCamera());
+#if WITH_EDITORONLY_DATA
+	if (AmmoLedger)
+	{
+		if (Starting9mmAmmo_DEPRECATED != INDEX_NONE)
+		{
+			AmmoLedger->SetStartingAmmo(EAmmoType::EAT_9mm, Starting9mmAmmo_DEPRECATED);
+			Starting9mmAmmo_DEPRECATED = INDEX_NONE;
+		}
+		if (StartingARAmmo_DEPRECATED != INDEX_NONE)
+		{
+			AmmoLedger->SetStartingAmmo(EAmmoType::EAT_AR, StartingARAmmo_DEPRECATED);
+			StartingARAmmo_DEPRECATED = INDEX_NONE;
+		}
+	}
+#endif
 }
 
 // Called when the game starts or when spawned
@@ -151,6 +181,12 @@ void AShooterCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// so explosions can find us
+	if (UDamageableGridSubsystem* Grid = GetWorld()->GetSubsystem<UDamageableGridSubsystem>())
+	{
+		Grid->Register(this);
+	}
+
 	if (FollowCamera)
 	{
 		CameraDefaultFOV = GetFollowCamera()->FieldOfView;
@@ -158,20 +194,37 @@ void AShooterCharacter::BeginPlay()
 
 	}
 
+	if (PickupWidgetClass == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s has no PickupWidgetClass, pickup prompts won't show. Set it to a widget Blueprint derived from UPickupWidget"), *GetClass()->GetName());
+	}
+
 	//Spawn the default weapon and Equip it
+	Inventory->EquipFlushedDelegate.AddUObject(this, &AShooterCharacter::BroadcastEquipItem);
 	EquipWeapon(SpawnDefaultWeapon());
-	Inventory.Add(EquippedWeapon);
-	EquippedWeapon->SetSlotIndex(0);
+	Inventory->AddItem(EquippedWeapon);
 	EquippedWeapon->DisableCustomDepth();
 	EquippedWeapon->DisableGlowMaterial();
 	EquippedWeapon->SetCharacter(this);
 
-	InitializeAmmoMap();
-
 	GetCharacterMovement()->MaxWalkSpeed = BaseMovementSpeed;
 
 	// create FInterpLocation structs for each interp location. Add to array
 	InitializeInterpLocations();
+
+	// Build the per surface penetration lookup
+	BulletTracer.Initialize(SurfacePenetrationDataTable);
+	BulletTracer.MaxSegments = MaxBulletSegments;
+}
+
+void AShooterCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UDamageableGridSubsystem* Grid = GetWorld()->GetSubsystem<UDamageableGridSubsystem>())
+	{
+		Grid->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AShooterCharacter::MoveForward(float Value)
@@ -263,7 +316,7 @@ void AShooterCharacter::FireWeapon()
 	}
 }
 
-bool AShooterCharacter::GetBeamEndLocation(const FVector& MuzzleSocketLocation, FHitResult& OutHitResult)
+bool AShooterCharacter::GetBeamEndLocation(const FVector& MuzzleSocketLocation, FBulletPath& OutBulletPath)
 {
 	FHitResult CrosshairHitResult;
 
@@ -282,21 +335,15 @@ bool AShooterCharacter::GetBeamEndLocation(const FVector& MuzzleSocketLocation,
 	}
 	//Get Current Size of the viewport
 
-	/* perform a 2nd trace, from the gun barrel this time*/
-	const FVector WeaponTraceStart{ MuzzleSocketLocation };
+	/* perform a 2nd trace, from the gun barrel this time, following penetrations and ricochets*/
 	const FVector StartToEnd{ OutBeamLocation - MuzzleSocketLocation };
-	const FVector WeaponTraceEnd{ MuzzleSocketLocation + StartToEnd * 1.25f };
-	GetWorld()->LineTraceSingleByChannel(
-		OutHitResult, 
-		WeaponTraceStart, 
-		WeaponTraceEnd, 
-		ECollisionChannel::ECC_Visibility);
-	if (!OutHitResult.bBlockingHit) //object between barren and BeamEndpoint?
-	{
-		OutHitResult.Location = OutBeamLocation;
-		return false;
-	}
-	return true;
+	return BulletTracer.TracePath(
+		GetWorld(),
+		MuzzleSocketLocation,
+		StartToEnd,
+		StartToEnd.Size() * 1.25f,
+		this,
+		OutBulletPath);
 }
 
 void AShooterCharacter::AimingButtonPressed()
@@ -447,7 +494,7 @@ void AShooterCharacter::AutoFireReset()
 	}
 }
 
-bool AShooterCharacter::TraceUnderCrosshairs(FHitResult& OutHitResult, FVector& OutHitLocation)
+bool AShooterCharacter::GetCrosshairTrace(FVector& OutStart, FVector& OutEnd) const
 {
 	// Get Viewport Size
 	FVector2D ViewportSize;
@@ -464,17 +511,29 @@ bool AShooterCharacter::TraceUnderCrosshairs(FHitResult& OutHitResult, FVector&
 	// Get world position and direction of crosshairs
 	bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(UGameplayStatics::GetPlayerController(this, 0), CrosshairLocation, CrosshairWorldPosition, CrosshairWorldDirection);
 
-	if (bScreenToWorld)
-	{
-		// Trace from Crosshair world location outward
-		const FVector Start{ CrosshairWorldPosition };
-		const FVector End{ Start + CrosshairWorldDirection * 50'000.f };
-		OutHitLocation = End;
-		GetWorld()->LineTraceSingleByChannel(
-			OutHitResult,
-			Start,
-			End,
-			ECollisionChannel::ECC_Visibility);
+	if (!bScreenToWorld)
+	{
+		// no local player, e.g. a headless world, the crosshairs are in the middle of the camera's view
+		if (FollowCamera == nullptr) return false;
+		CrosshairWorldPosition = FollowCamera->GetComponentLocation();
+		CrosshairWorldDirection = FollowCamera->GetForwardVector();
+	}
+
+	// Trace from Crosshair world location outward
+	OutStart = CrosshairWorldPosition;
+	OutEnd = OutStart + CrosshairWorldDirection * 50'000.f;
+	return true;
+}
+
+bool AShooterCharacter::TraceUnderCrosshairs(FHitResult& OutHitResult, FVector& OutHitLocation)
+{
+	FTraceRequest Request;
+	Request.Category = ETraceCategory::Combat;
+	Request.Channel = ECollisionChannel::ECC_Visibility;
+	if (GetCrosshairTrace(Request.Start, Request.End))
+	{
+		OutHitLocation = Request.End;
+		UTraceSchedulerSubsystem::TraceNow(this, Request, OutHitResult);
 		if (OutHitResult.bBlockingHit)
 		{
 			OutHitLocation = OutHitResult.Location;
@@ -489,9 +548,33 @@ void AShooterCharacter::TraceForItems()
 {
 	if (bShouldTraceForItems)
 	{
-		FHitResult ItemTraceResult;
-		FVector HitLocation;
-		TraceUnderCrosshairs(ItemTraceResult, HitLocation);
+		const float Now{ GetWorld()->GetTimeSeconds() };
+		FTraceRequest Request;
+		Request.Category = ETraceCategory::Interaction;
+		Request.Channel = ECollisionChannel::ECC_Visibility;
+		if (Now > ItemTraceDeadlineTime && GetCrosshairTrace(Request.Start, Request.End))
+		{
+			// over budget the trace waits and last frame's focus is kept meanwhile
+			ItemTraceDeadlineTime = Now + Request.Deadline;
+			UTraceSchedulerSubsystem::Submit(this, Request, FTraceDoneDelegate::CreateUObject(this, &AShooterCharacter::OnItemTraceDone));
+		}
+	}
+	else if (TraceHitItemLastFrame)
+	{
+		// No longer overlapping any items,
+		// Item last frame should not show widget
+		HidePickupWidget();
+		TraceHitItemLastFrame->DisableCustomDepth();
+	}
+}
+
+void AShooterCharacter::OnItemTraceDone(const FHitResult& ItemTraceResult)
+{
+	ItemTraceDeadlineTime = 0.f;
+
+	// a deferred trace may finish after we stopped overlapping items
+	if (bShouldTraceForItems)
+	{
 		if (ItemTraceResult.bBlockingHit)
 		{
 			TraceHitItem = Cast<AItem>(ItemTraceResult.GetActor()); 
@@ -520,13 +603,11 @@ void AShooterCharacter::TraceForItems()
 				TraceHitItem = nullptr;
 			}
 
-			if (TraceHitItem && TraceHitItem->GetPickupWidget())
+			if (TraceHitItem)
 			{
-				// Show Item's Pickup Widget
-				TraceHitItem->GetPickupWidget()->SetVisibility(true);
 				TraceHitItem->EnableCustomDepth();
 
-				if (Inventory.Num() >= INVENTORY_CAPACITY)
+				if (Inventory->IsFull())
 				{
 					// inventory is full
 					TraceHitItem->SetCharacterInventoryFull(true);
@@ -537,6 +618,9 @@ void AShooterCharacter::TraceForItems()
 					TraceHitItem->SetCharacterInventoryFull(false);
 
 				}
+
+				// Show the pickup widget over this item
+				ShowPickupWidget(TraceHitItem);
 			}
 			// we hit a AItem last frame
 			if (TraceHitItemLastFrame)
@@ -545,7 +629,11 @@ void AShooterCharacter::TraceForItems()
 				{
 					//we hitting a different AItem this frame from last frame
 					// or AItem is NULL
-					TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
+					// a new item already moved the widget over itself
+					if (TraceHitItem == nullptr)
+					{
+						HidePickupWidget();
+					}
 					TraceHitItemLastFrame->DisableCustomDepth();
 				}
 			}
@@ -553,12 +641,43 @@ void AShooterCharacter::TraceForItems()
 			TraceHitItemLastFrame = TraceHitItem;
 		}
 	}
-	else if (TraceHitItemLastFrame)
+}
+
+void AShooterCharacter::ShowPickupWidget(AItem* Item)
+{
+	UPickupWidget* Widget = Cast<UPickupWidget>(PickupWidgetComponent->GetUserWidgetObject());
+	if (Widget == nullptr && PickupWidgetClass)
 	{
-		// No longer overlapping any items,
-		// Item last frame should not show widget
-		TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
-		TraceHitItemLastFrame->DisableCustomDepth();
+		// nothing is created until the first time we look at an item
+		PickupWidgetComponent->SetWidgetClass(PickupWidgetClass);
+		Widget = Cast<UPickupWidget>(PickupWidgetComponent->GetUserWidgetObject());
+	}
+	if (Widget == nullptr) return;
+
+	if (Widget->GetItem() != Item)
+	{
+		Widget->SetItem(Item);
+	}
+	else
+	{
+		Widget->SetInventoryFull(Item->IsCharacterInventoryFull());
+	}
+
+	// follow the item, a dropped weapon can still be falling
+	const FBoxSphereBounds& Bounds{ Item->GetCollisionBox()->Bounds };
+	PickupWidgetComponent->SetWorldLocation(Bounds.Origin + FVector(0.f, 0.f, Bounds.BoxExtent.Z + PickupWidgetHeight));
+	PickupWidgetComponent->SetVisibility(true);
+}
+
+void AShooterCharacter::HidePickupWidget()
+{
+	PickupWidgetComponent->SetVisibility(false);
+	if (UPickupWidget* Widget = Cast<UPickupWidget>(PickupWidgetComponent->GetUserWidgetObject()))
+	{
+		if (Widget->GetItem())
+		{
+			Widget->SetItem(nullptr);
+		}
 	}
 }
 
@@ -587,11 +706,11 @@ void AShooterCharacter::EquipWeapon(AWeapon* WeaponToEquip, bool bSwapping)
 		if (EquippedWeapon == nullptr)
 		{
 			// -1 == no EquippedWeapon yet. No need to reverse the icon animation
-			EquipItemDelegate.Broadcast(-1, WeaponToEquip->GetSlotIndex());
+			Inventory->QueueEquip(-1, WeaponToEquip->GetSlotIndex());
 		}
 		else if (!bSwapping)
 		{
-			EquipItemDelegate.Broadcast(EquippedWeapon->GetSlotIndex(), WeaponToEquip->GetSlotIndex());
+			Inventory->QueueEquip(EquippedWeapon->GetSlotIndex(), WeaponToEquip->GetSlotIndex());
 		}
 
 		// Set EquippedWeapon to the newly spawned Weapon
@@ -631,10 +750,9 @@ void AShooterCharacter::SelectButtonReleased()
 
 void AShooterCharacter::SwapWeapon(AWeapon* WeaponToSwap)
 {
-	if (Inventory.Num() -1 >= EquippedWeapon->GetSlotIndex())
+	if (Inventory->GetItem(EquippedWeapon->GetSlotIndex()) == EquippedWeapon)
 	{
-		Inventory[EquippedWeapon->GetSlotIndex()] = WeaponToSwap;
-		WeaponToSwap->SetSlotIndex(EquippedWeapon->GetSlotIndex());
+		Inventory->SetItem(EquippedWeapon->GetSlotIndex(), WeaponToSwap);
 	}
 
 	DropWeapon();
@@ -643,12 +761,6 @@ void AShooterCharacter::SwapWeapon(AWeapon* WeaponToSwap)
 	TraceHitItemLastFrame = nullptr;
 }
 
-void AShooterCharacter::InitializeAmmoMap()
-{
-	AmmoMap.Add(EAmmoType::EAT_9mm, Starting9mmAmmo);
-	AmmoMap.Add(EAmmoType::EAT_AR, StartingARAmmo);
-}
-
 bool AShooterCharacter::WeaponHasAmmo()
 {
 	if (EquippedWeapon == nullptr) return false;
@@ -675,79 +787,128 @@ void AShooterCharacter::SendBullet()
 
 		if (EquippedWeapon->GetMuzzleFlash())
 		{
-			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), EquippedWeapon->GetMuzzleFlash(), SocketTransform);
+			// pooled like every per-shot effect, a steady rate of fire reuses the same components
+			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), EquippedWeapon->GetMuzzleFlash(), SocketTransform, true, EPSCPoolMethod::AutoRelease);
 		}
 
-		FHitResult BeamHitResult;
-		bool bBeamEnd = GetBeamEndLocation(SocketTransform.GetLocation(), BeamHitResult);
+		if (EquippedWeapon->IsProjectile())
+		{
+			// simulated bullet, hits are resolved by the projectile subsystem
+			FireProjectile(SocketTransform);
+			return;
+		}
+
+		FBulletPath BulletPath;
+		bool bBeamEnd = GetBeamEndLocation(SocketTransform.GetLocation(), BulletPath);
 		if (bBeamEnd)
 		{
-			// does hit actor implement BulletHitInterface
-			if (BeamHitResult.GetActor())
+			// damage everything the bullet went through, scaled by what's left of it
+			for (const FBulletImpact& Impact : BulletPath.Impacts)
 			{
-				IBUlletHitInterface* BulletHitInterface = Cast<IBUlletHitInterface>(BeamHitResult.GetActor());
-				if (BulletHitInterface)
-				{
-					BulletHitInterface->BulletHit_Implementation(BeamHitResult, this, GetController());
+				ApplyBulletHit(
+					Impact.HitResult,
+					EquippedWeapon->GetDamage() * Impact.DamageMultiplier,
+					EquippedWeapon->GetHeadshotDamage() * Impact.DamageMultiplier);
+			}
 
-				}
-				AEnemy* HitEnemy = Cast<AEnemy>(BeamHitResult.GetActor());
-				if (HitEnemy)
+			// one beam for each segment of the bullet's flight
+			for (int32 i = 0; i + 1 < BulletPath.Points.Num(); i++)
+			{
+				const FTransform BeamTransform{ i == 0 ? SocketTransform : FTransform(BulletPath.Points[i]) };
+				UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(
+					GetWorld(), 
+					BeamParticles, 
+					BeamTransform,
+					true,
+					EPSCPoolMethod::AutoRelease);
+
+				if (Beam)
 				{
-					int32 Damage{};
-					if (BeamHitResult.BoneName.ToString() == HitEnemy->GetHeadBone())
-					{
-						//HeadShot!
-						Damage = EquippedWeapon->GetHeadshotDamage();
-						UGameplayStatics::ApplyDamage(
-							BeamHitResult.GetActor(),
-							Damage,
-							GetController(), 
-							this,
-							UDamageType::StaticClass());
-					}
-					else
-					{
-						//Body Shot
-						Damage = EquippedWeapon->GetDamage();
-						UGameplayStatics::ApplyDamage(
-							BeamHitResult.GetActor(),
-							Damage,
-							GetController(), this,
-							UDamageType::StaticClass());
-					}
-
-					HitEnemy->ShowHitNumber(Damage, BeamHitResult.Location);
+					Beam->SetVectorParameter(FName("Target"), BulletPath.Points[i + 1]);
 				}
 			}
-			else
-			{
-				// spawn default particles
+		}
+		
 
-				if (ImpactParticles)
-				{
-					UGameplayStatics::SpawnEmitterAtLocation(
-						GetWorld(), 
-						ImpactParticles, 
-						BeamHitResult.Location);
-				}
+		// Start Bullet fire timer for CROSSHAIRS
+		//StartCrosshairBulletFire();
+	}
+}
 
-			}
+void AShooterCharacter::FireProjectile(const FTransform& SocketTransform)
+{
+	UProjectileSubsystem* ProjectileSubsystem = GetWorld()->GetSubsystem<UProjectileSubsystem>();
+	if (ProjectileSubsystem == nullptr) return;
 
-			UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(
-				GetWorld(), 
-				BeamParticles, 
-				SocketTransform);
+	// aim the bullet at whatever is under the crosshairs
+	FHitResult CrosshairHitResult;
+	FVector AimLocation;
+	TraceUnderCrosshairs(CrosshairHitResult, AimLocation);
 
-			if (Beam)
+	const FVector Origin{ SocketTransform.GetLocation() };
+	FVector Direction{ (AimLocation - Origin).GetSafeNormal() };
+	if (Direction.IsZero())
+	{
+		// aim point right at the muzzle, fire along the barrel
+		Direction = SocketTransform.GetUnitAxis(EAxis::X);
+	}
+
+	FProjectileSpawnParams Params;
+	Params.Shooter = this;
+	Params.Origin = Origin;
+	Params.Velocity = Direction * EquippedWeapon->GetMuzzleVelocity();
+	Params.GravityScale = EquippedWeapon->GetBulletGravityScale();
+	Params.Drag = EquippedWeapon->GetBulletDrag();
+	Params.Damage = EquippedWeapon->GetDamage();
+	Params.HeadshotDamage = EquippedWeapon->GetHeadshotDamage();
+	ProjectileSubsystem->FireBullet(Params);
+}
+
+void AShooterCharacter::ApplyBulletHit(const FHitResult& HitResult, float BodyDamage, float HeadshotDamage)
+{
+	// does hit actor implement BulletHitInterface
+	if (HitResult.GetActor())
+	{
+		IBUlletHitInterface* BulletHitInterface = Cast<IBUlletHitInterface>(HitResult.GetActor());
+		if (BulletHitInterface)
+		{
+			BulletHitInterface->BulletHit_Implementation(HitResult, this, GetController());
+
+		}
+		AEnemy* HitEnemy = Cast<AEnemy>(HitResult.GetActor());
+		if (HitEnemy)
+		{
+			const bool bHeadshot{ HitResult.BoneName.ToString() == HitEnemy->GetHeadBone() };
+			UDamageQueueSubsystem* DamageQueue = GetWorld()->GetSubsystem<UDamageQueueSubsystem>();
+			if (DamageQueue)
 			{
-				Beam->SetVectorParameter(FName("Target"), BeamHitResult.Location);
+				// HeadShot or body shot, merged with any other hits on this enemy this frame
+				DamageQueue->QueueDamage(
+					HitEnemy,
+					bHeadshot ? HeadshotDamage : BodyDamage,
+					GetController(),
+					this,
+					HitResult.Location,
+					bHeadshot);
 			}
 		}
-		
+	}
+	else
+	{
+		// spawn default particles
+
+		if (ImpactParticles)
+		{
+			UGameplayStatics::SpawnEmitterAtLocation(
+				GetWorld(), 
+				ImpactParticles, 
+				HitResult.Location,
+				FRotator::ZeroRotator,
+				FVector(1.f),
+				true,
+				EPSCPoolMethod::AutoRelease);
+		}
 
-		// Start Bullet fire timer for CROSSHAIRS
-		//StartCrosshairBulletFire();
 	}
 }
 
@@ -794,19 +955,9 @@ void AShooterCharacter::ReloadWeapon()
 
 bool AShooterCharacter::CarryingAmmo()
 {
-
 	if (EquippedWeapon == nullptr) return false;
-	
-		auto AmmoType = EquippedWeapon->GetAmmoType();
-
-		if (AmmoMap.Contains(AmmoType))
-		{
-			return AmmoMap[AmmoType] > 0;
-		}
 
-		return false;
-	
-	
+	return AmmoLedger->HasAmmo(EquippedWeapon->GetAmmoType());
 }
 
 void AShooterCharacter::GrabClip()
@@ -904,15 +1055,8 @@ void AShooterCharacter::StopAiming()
 
 void AShooterCharacter::PickupAmmo(AAmmo* Ammo)
 {
-	// check to see if AmmoMap contains ammo's AmmoType
-	if (AmmoMap.Find(Ammo->GetAmmoType()))
-	{
-		// Get Amount of ammo in our ammo map for ammo's type
-		int32 AmmoCount{ AmmoMap[Ammo->GetAmmoType()] };
-		AmmoCount += Ammo->GetItemCount();
-		// set the amount of ammo in the map for this type
-		AmmoMap[Ammo->GetAmmoType()] = AmmoCount;
-	}
+	// anything over the cap for this type is lost with the pickup
+	AmmoLedger->AddAmmo(Ammo->GetAmmoType(), Ammo->GetItemCount());
 
 	if (EquippedWeapon->GetAmmoType() == Ammo-> GetAmmoType())
 	{
@@ -928,69 +1072,35 @@ void AShooterCharacter::PickupAmmo(AAmmo* Ammo)
 
 void AShooterCharacter::InitializeInterpLocations()
 {
-	FInterpLocation WeaponLocation{ WeaponInterpComp, 0 };
-	InterpLocations.Add(WeaponLocation);
-
-	FInterpLocation InterpLoc1{ InterpComp1, 0 };
-	InterpLocations.Add(InterpLoc1);
-
-	FInterpLocation InterpLoc2{ InterpComp2, 0 };
-	InterpLocations.Add(InterpLoc2);
-
-	FInterpLocation InterpLoc3{ InterpComp3, 0 };
-	InterpLocations.Add(InterpLoc3);
+	InterpLocations.Reset(NumInterpAnchors + 1);
 
-	FInterpLocation InterpLoc4{ InterpComp4, 0 };
-	InterpLocations.Add(InterpLoc4);
-
-	FInterpLocation InterpLoc5{ InterpComp5, 0 };
-	InterpLocations.Add(InterpLoc5);
-
-	FInterpLocation InterpLoc6{ InterpComp6, 0 };
-	InterpLocations.Add(InterpLoc6);
-}
+	// weapons fly to a single location straight ahead of the camera
+	InterpLocations.Add(FInterpLocation{ FVector(CameraInterpDistance, 0.f, CamerainterpElevation), 0 });
 
-void AShooterCharacter::OneKeyPressed()
-{
-	if (EquippedWeapon->GetSlotIndex() == 0) return;
-	ExchangeInventoryitems(EquippedWeapon->GetSlotIndex(), 0);
-}
-
-void AShooterCharacter::TwoKeyPressed()
-{
-	if (EquippedWeapon->GetSlotIndex() == 1) return;
-	ExchangeInventoryitems(EquippedWeapon->GetSlotIndex(), 1);
-}
-
-void AShooterCharacter::ThreeKeyPressed()
-{
-	if (EquippedWeapon->GetSlotIndex() == 2) return;
-	ExchangeInventoryitems(EquippedWeapon->GetSlotIndex(), 2);
-}
-
-void AShooterCharacter::FourKeyPressed()
-{
-	if (EquippedWeapon->GetSlotIndex() == 3) return;
-	ExchangeInventoryitems(EquippedWeapon->GetSlotIndex(), 3);
-}
+	// item anchors spread evenly over a disc facing the camera, sunflower pattern so any count fans out evenly
+	const float GoldenAngle{ PI * (3.f - FMath::Sqrt(5.f)) };
+	for (int32 i = 0; i < NumInterpAnchors; i++)
+	{
+		const float Radius{ ItemInterpRadius * FMath::Sqrt((i + 0.5f) / NumInterpAnchors) };
+		float Sin, Cos;
+		FMath::SinCos(&Sin, &Cos, i * GoldenAngle);
+		InterpLocations.Add(FInterpLocation{ FVector(ItemInterpDistance, Radius * Cos, CamerainterpElevation + Radius * Sin), 0 });
+	}
 
-void AShooterCharacter::FiveKeyPressed()
-{
-	if (EquippedWeapon->GetSlotIndex() == 4) return;
-	ExchangeInventoryitems(EquippedWeapon->GetSlotIndex(), 4);
+	InterpAnchorHeap.Init(NumInterpAnchors);
 }
 
-void AShooterCharacter::SixKeyPressed()
+void AShooterCharacter::SlotKeyPressed(int32 Slot)
 {
-	if (EquippedWeapon->GetSlotIndex() == 5) return;
-	ExchangeInventoryitems(EquippedWeapon->GetSlotIndex(), 5);
+	if (EquippedWeapon->GetSlotIndex() == Slot) return;
+	ExchangeInventoryitems(EquippedWeapon->GetSlotIndex(), Slot);
 }
 
 void AShooterCharacter::ExchangeInventoryitems(int32 CurrentItemIndex, int32 NewitemIndex)
 {
 	const bool bCanExchangeItems= 
 		(CurrentItemIndex != NewitemIndex) &&
-		(NewitemIndex < Inventory.Num()) &&
+		(Cast<AWeapon>(Inventory->GetItem(NewitemIndex)) != nullptr) &&
 		(CombatState == ECombatState::ECS_Unoccupied || CombatState == ECombatState::ECS_Equipping);
 
 	if (bCanExchangeItems)
@@ -1000,7 +1110,7 @@ void AShooterCharacter::ExchangeInventoryitems(int32 CurrentItemIndex, int32 New
 			StopAiming();
 		}
 		auto OldEquippedWeapon = EquippedWeapon;
-		auto NewWeapon = Cast<AWeapon>(Inventory[NewitemIndex]);
+		auto NewWeapon = Cast<AWeapon>(Inventory->GetItem(NewitemIndex));
 		EquipWeapon(NewWeapon);
 
 		OldEquippedWeapon->SetItemState(EItemState::EIS_PickedUp);
@@ -1017,25 +1127,14 @@ void AShooterCharacter::ExchangeInventoryitems(int32 CurrentItemIndex, int32 New
 	}
 }
 
-int32 AShooterCharacter::GetEmptyInventorySlot()
+void AShooterCharacter::BroadcastEquipItem(int32 CurrentSlotIndex, int32 NewSlotIndex)
 {
-	for (int32 i = 0; i < Inventory.Num(); i++)
-	{
-		if (Inventory[i] == nullptr)
-		{
-			return i;
-		}
-	}
-	if (Inventory.Num() < INVENTORY_CAPACITY)
-	{
-		return Inventory.Num();
-	}
-	return -1; // inventory is full
+	EquipItemDelegate.Broadcast(CurrentSlotIndex, NewSlotIndex);
 }
 
 void AShooterCharacter::HighlightInventorySlot()
 {
-	const int32 EmptySlot{ GetEmptyInventorySlot() };
+	const int32 EmptySlot{ Inventory->FindFreeSlot() }; // -1 when the inventory is full
 	HighlightIconDelegate.Broadcast(EmptySlot, true);
 	HighlightedSlot = EmptySlot;
 }
@@ -1043,19 +1142,7 @@ void AShooterCharacter::HighlightInventorySlot()
 
 EPhysicalSurface AShooterCharacter::GetSurfaceType()
 {
-	FHitResult HitResult;
-	const FVector Start{ GetActorLocation() };
-	const FVector End{ Start + FVector(0.f, 0.f, -400.f) };
-	FCollisionQueryParams QueryParams;
-	QueryParams.bReturnPhysicalMaterial = true;
-
-	GetWorld()->LineTraceSingleByChannel(
-		HitResult,
-		Start,
-		End,
-		ECollisionChannel::ECC_Visibility,
-		QueryParams);
-	return UPhysicalMaterial::DetermineSurfaceType(HitResult.PhysMaterial.Get());
+	return GroundSurface.GetSurface(this);
 }
 void AShooterCharacter::EndStun()
 {
@@ -1073,6 +1160,11 @@ void AShooterCharacter::UnHighlightInventorySlot()
 	HighlightedSlot = -1;
 }
 
+TArray<AItem*> AShooterCharacter::GetInventoryItems() const
+{
+	return Inventory ? Inventory->GetItems() : TArray<AItem*>();
+}
+
 void AShooterCharacter::Stun()
 {
 	if (Health <= 0.f) return;
@@ -1087,18 +1179,9 @@ void AShooterCharacter::Stun()
 
 int32 AShooterCharacter::GetInterpLocationIndex()
 {
-	int32 LowestIndex = 1;
-	int32 LowestCount = INT_MAX;
-	for (int32 i = 1; i < InterpLocations.Num(); i++)
-	{
-		if (InterpLocations[i].ItemCount < LowestCount)
-		{
-			LowestIndex = i;
-			LowestCount = InterpLocations[i].ItemCount;
-		}
-	}
-
-	return LowestIndex;
+	// item anchors start at 1, 0 is the weapon location
+	const int32 Anchor{ InterpAnchorHeap.Top() };
+	return Anchor == INDEX_NONE ? 0 : Anchor + 1;
 }
 
 
@@ -1137,29 +1220,151 @@ void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCo
 	PlayerInputComponent->BindAxis("Turn", this, &AShooterCharacter::Turn);
 	PlayerInputComponent->BindAxis("LookUp", this, &AShooterCharacter::LookUp);
 
-	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &AShooterCharacter::Jump);
-	PlayerInputComponent->BindAction("Jump", IE_Released, this, &ACharacter::StopJumping);
+	// actions carry their replay id and whether they were pressed, slot keys come last
+	for (int32 Action = 0; Action < static_cast<int32>(EReplayAction::FirstSlotKey) + NumSlotKeys; Action++)
+	{
+		const FName ActionName{ ShooterReplay::GetActionName(static_cast<EReplayAction>(Action)) };
+		PlayerInputComponent->BindAction<FInputActionDelegate>(ActionName, IE_Pressed, this, &AShooterCharacter::InputAction, Action, true);
+		PlayerInputComponent->BindAction<FInputActionDelegate>(ActionName, IE_Released, this, &AShooterCharacter::InputAction, Action, false);
+	}
+
+}
+
+void AShooterCharacter::InputAction(int32 Action, bool bPressed)
+{
+	if (UReplaySubsystem* Replay = GetWorld()->GetSubsystem<UReplaySubsystem>())
+	{
+		Replay->RecordAction(static_cast<uint8>(Action), bPressed);
+	}
+
+	switch (static_cast<EReplayAction>(Action))
+	{
+	case EReplayAction::Jump:
+		if (bPressed) Jump();
+		else StopJumping();
+		break;
+	case EReplayAction::FireButton:
+		if (bPressed) FireButtonPressed();
+		else FireButtonReleased();
+		break;
+	case EReplayAction::AimingButton:
+		if (bPressed) AimingButtonPressed();
+		else AimingButtonReleased();
+		break;
+	case EReplayAction::Select:
+		if (bPressed) SelectButtonPressed();
+		else SelectButtonReleased();
+		break;
+	case EReplayAction::ReloadButton:
+		if (bPressed) ReloadButtonPressed();
+		break;
+	case EReplayAction::Crouch:
+		if (bPressed) CrouchButtonPressed();
+		break;
+	default:
+		// "1Key" selects slot 0 and so on
+		if (bPressed) SlotKeyPressed(Action - static_cast<int32>(EReplayAction::FirstSlotKey));
+		break;
+	}
+}
+
+void AShooterCharacter::ApplyReplayAxis(EReplayAxis Axis, float Value)
+{
+	switch (Axis)
+	{
+	case EReplayAxis::MoveForward:
+		MoveForward(Value);
+		break;
+	case EReplayAxis::MoveRight:
+		MoveRight(Value);
+		break;
+	case EReplayAxis::TurnRate:
+		TurnAtRate(Value);
+		break;
+	case EReplayAxis::LookUpRate:
+		LookUpAtRate(Value);
+		break;
+	case EReplayAxis::Turn:
+		Turn(Value);
+		break;
+	case EReplayAxis::LookUp:
+		LookUp(Value);
+		break;
+	}
+}
+
+void AShooterCharacter::SaveSnapshot(FPlayerSnapshot& OutSnapshot) const
+{
+	OutSnapshot.Location = GetActorLocation();
+	OutSnapshot.ControlRotation = GetControlRotation();
+	OutSnapshot.Health = Health;
+
+	OutSnapshot.Ammo.SetNum(static_cast<int32>(EAmmoType::EAT_MAX));
+	for (int32 i = 0; i < OutSnapshot.Ammo.Num(); i++)
+	{
+		OutSnapshot.Ammo[i] = AmmoLedger->GetAmmo(static_cast<EAmmoType>(i));
+	}
 
-	PlayerInputComponent->BindAction("FireButton", IE_Pressed, this, &AShooterCharacter::FireButtonPressed);
-	PlayerInputComponent->BindAction("FireButton", IE_Released, this, &AShooterCharacter::FireButtonReleased);
+	OutSnapshot.EquippedSlot = EquippedWeapon ? EquippedWeapon->GetSlotIndex() : INDEX_NONE;
+}
 
-	PlayerInputComponent->BindAction("AimingButton", IE_Pressed, this, &AShooterCharacter::AimingButtonPressed);
-	PlayerInputComponent->BindAction("AimingButton", IE_Released, this, &AShooterCharacter::AimingButtonReleased);
+void AShooterCharacter::LoadSnapshot(const FPlayerSnapshot& Snapshot, TFunctionRef<AItem*(const FItemSnapshot&)> SpawnItem)
+{
+	SetActorLocation(Snapshot.Location, false, nullptr, ETeleportType::ResetPhysics);
+	if (Controller)
+	{
+		Controller->SetControlRotation(Snapshot.ControlRotation);
+	}
+	Health = FMath::Clamp(Snapshot.Health, 0.f, MaxHealth);
 
-	PlayerInputComponent->BindAction("Select", IE_Pressed, this, &AShooterCharacter::SelectButtonPressed);
-	PlayerInputComponent->BindAction("Select", IE_Released, this, &AShooterCharacter::SelectButtonReleased);
+	const int32 NumAmmoTypes{ FMath::Min(Snapshot.Ammo.Num(), static_cast<int32>(EAmmoType::EAT_MAX)) };
+	for (int32 i = 0; i < NumAmmoTypes; i++)
+	{
+		const EAmmoType AmmoType{ static_cast<EAmmoType>(i) };
+		AmmoLedger->TakeAmmo(AmmoType, AmmoLedger->GetAmmo(AmmoType));
+		AmmoLedger->AddAmmo(AmmoType, Snapshot.Ammo[i]);
+	}
 
-	PlayerInputComponent->BindAction("ReloadButton", IE_Pressed, this, &AShooterCharacter::ReloadButtonPressed);
+	// the saved inventory replaces what we are carrying
+	EquippedWeapon = nullptr;
+	for (int32 Slot = 0; Slot < Inventory->GetCapacity(); Slot++)
+	{
+		if (AItem* Item = Inventory->RemoveItem(Slot))
+		{
+			Item->Destroy();
+		}
+	}
 
-	PlayerInputComponent->BindAction("Crouch", IE_Pressed, this, &AShooterCharacter::CrouchButtonPressed);
+	for (const FItemSnapshot& ItemSnapshot : Snapshot.Inventory)
+	{
+		AWeapon* Weapon{ Cast<AWeapon>(SpawnItem(ItemSnapshot)) };
+		if (Weapon == nullptr) continue;
+		if (ItemSnapshot.SlotIndex < 0 || ItemSnapshot.SlotIndex >= Inventory->GetCapacity())
+		{
+			Weapon->Destroy();
+			continue;
+		}
 
-	PlayerInputComponent->BindAction("1Key", IE_Pressed, this, &AShooterCharacter::OneKeyPressed);
-	PlayerInputComponent->BindAction("2Key", IE_Pressed, this, &AShooterCharacter::TwoKeyPressed);
-	PlayerInputComponent->BindAction("3Key", IE_Pressed, this, &AShooterCharacter::ThreeKeyPressed);
-	PlayerInputComponent->BindAction("4Key", IE_Pressed, this, &AShooterCharacter::FourKeyPressed);
-	PlayerInputComponent->BindAction("5Key", IE_Pressed, this, &AShooterCharacter::FiveKeyPressed);
-	PlayerInputComponent->BindAction("6Key", IE_Pressed, this, &AShooterCharacter::SixKeyPressed);
+		Inventory->SetItem(ItemSnapshot.SlotIndex, Weapon);
+		Weapon->SetCharacter(this);
+		Weapon->DisableCustomDepth();
+		Weapon->DisableGlowMaterial();
+		if (ItemSnapshot.SlotIndex == Snapshot.EquippedSlot)
+		{
+			EquipWeapon(Weapon);
+		}
+		else
+		{
+			Weapon->SetItemState(EItemState::EIS_PickedUp);
+		}
+	}
 
+	// the saved equipped slot didn't come back, hold whatever is first
+	for (int32 Slot = 0; EquippedWeapon == nullptr && Slot < Inventory->GetCapacity(); Slot++)
+	{
+		EquipWeapon(Cast<AWeapon>(Inventory->GetItem(Slot)));
+	}
+	CombatState = ECombatState::ECS_Unoccupied;
 }
 
 float AShooterCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
@@ -1224,32 +1429,13 @@ void AShooterCharacter::FinishReloading()
 	if (EquippedWeapon == nullptr) return;
 	const auto AmmoType{ EquippedWeapon->GetAmmoType() };
 
-	// Update the AmmoMap
-	if (AmmoMap.Contains(AmmoType))
-	{
-		// Amount of ammo the Character is carrying of the EquippedWeapon type
-		int32 CarriedAmmo = AmmoMap[AmmoType];
-
-		// Space left in the magazine of EquippedWeapon
-		const int32 MagEmptySpace =
-			EquippedWeapon->GetMagazineCapacity() -
-			EquippedWeapon->GetAmmo();
+	// Space left in the magazine of EquippedWeapon
+	const int32 MagEmptySpace =
+		EquippedWeapon->GetMagazineCapacity() -
+		EquippedWeapon->GetAmmo();
 
-		if (MagEmptySpace > CarriedAmmo)
-		{
-			// Reload the magazine with all the ammo we are carrying
-			EquippedWeapon->ReloadAmmo(CarriedAmmo);
-			CarriedAmmo = 0;
-			AmmoMap.Add(AmmoType, CarriedAmmo);
-		}
-		else
-		{
-			// fill the magazine
-			EquippedWeapon->ReloadAmmo(MagEmptySpace);
-			CarriedAmmo -= MagEmptySpace;
-			AmmoMap.Add(AmmoType, CarriedAmmo);
-		}
-	}
+	// fill the magazine with as much of the carried ammo as fits
+	EquippedWeapon->ReloadAmmo(AmmoLedger->TakeAmmo(AmmoType, MagEmptySpace));
 }
 
 void AShooterCharacter::FinishEquipping()
@@ -1307,10 +1493,8 @@ void AShooterCharacter::GetPickupItem(AItem* Item)
 	auto Weapon = Cast<AWeapon>(Item);
 	if (Weapon)
 	{
-		if (Inventory.Num() < INVENTORY_CAPACITY)
+		if (Inventory->AddItem(Weapon) != INDEX_NONE)
 		{
-			Weapon->SetSlotIndex(Inventory.Num());
-			Inventory.Add(Weapon);
 			Weapon->SetItemState(EItemState::EIS_PickedUp);
 		}
 		else // inventory is full, swap with equipped weapon
@@ -1328,7 +1512,7 @@ void AShooterCharacter::GetPickupItem(AItem* Item)
 
 FInterpLocation AShooterCharacter::GetInterpLocation(int32 Index)
 {
-	if (Index <= InterpLocations.Num())
+	if (InterpLocations.IsValidIndex(Index))
 	{
 		return InterpLocations[Index];
 	}
@@ -1339,9 +1523,13 @@ void AShooterCharacter::IncrementInterpLocItemCount(int32 Index, int32 Amount)
 {
 	if (Amount < -1 || Amount > 1) return;
 
-	if (InterpLocations.Num() >= Index)
+	if (InterpLocations.IsValidIndex(Index))
 	{
 		InterpLocations[Index].ItemCount += Amount;
+		if (Index > 0)
+		{
+			InterpAnchorHeap.Adjust(Index - 1, Amount);
+		}
 	}
 }
 
@@ -5,6 +5,11 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "AmmoType.h"
+#include "BulletPath.h"
+#include "InterpAnchorHeap.h"
+#include "TraceSchedulerSubsystem.h"
+#include "GroundSurfaceCache.h"
+#include "ShooterReplay.h"
 #include "ShooterCharacter.generated.h"
 
 UENUM(BlueprintType)
@@ -24,30 +29,40 @@ struct FInterpLocation
 {
 	GENERATED_BODY()
 
-	// Scene component to use for its location for interping
+	// Location relative to the follow camera to use for interping
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
-	USceneComponent* SceneComponent;
+	FVector Offset{ FVector::ZeroVector };
 
 	//number of items interping to / at this scene comp location
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
-	int32 ItemCount;
+	int32 ItemCount{ 0 };
 };
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FEquipItemDelegate, int32, CurrentSlotIndex, int32, NewSlotIndex);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FHighlightIconDelegate, int32, SlotIndex, bool, bStartAnimation);
+DECLARE_DELEGATE_TwoParams(FInputActionDelegate, int32, bool);
+
+struct FPlayerSnapshot;
+struct FItemSnapshot;
 
 UCLASS()
 class SHOOTER_API AShooterCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	// fires and traces for items like the input bindings would
+	friend class FCombatAllocationTest;
+
 public:
 	// Sets default values for this character's properties
 	AShooterCharacter();
 
+	virtual void PostLoad() override;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	/** Called for forwards/backwards input */
 	void MoveForward(float Value);
@@ -78,7 +93,8 @@ protected:
 	/** Called when the Fire Button is pressed */
 	void FireWeapon();
 
-	bool GetBeamEndLocation(const FVector& MuzzleSocketLocation, FHitResult& OutHitResult);
+	// Traces from the muzzle toward the crosshairs, following penetrations and ricochets
+	bool GetBeamEndLocation(const FVector& MuzzleSocketLocation, FBulletPath& OutBulletPath);
 
 	/*Set bAiming to true and false with button press...*/
 	void AimingButtonPressed();
@@ -104,12 +120,22 @@ protected:
 	UFUNCTION()
 	void AutoFireReset();
 
-	// Line trace for items under the crosshairs
+	// Start and end of a line from the camera through the crosshairs, along the camera when there's no viewport
+	bool GetCrosshairTrace(FVector& OutStart, FVector& OutEnd) const;
+
+	// Line trace under the crosshairs
 	bool TraceUnderCrosshairs(FHitResult& OutHitResult, FVector& OutHitLocation);
 
-	// Trace for items if overlapped item count is > 0
+	// Trace for items if overlapped item count is > 0, the trace waits while the frame's trace budget is spent
 	void TraceForItems();
 
+	// Focuses the item the item trace hit
+	void OnItemTraceDone(const FHitResult& ItemTraceResult);
+
+	// Fill the shared pickup widget from Item and move it over the item, creating the widget on first use
+	void ShowPickupWidget(class AItem* Item);
+	void HidePickupWidget();
+
 	// Spawns a default weapon and equips it
 	class AWeapon* SpawnDefaultWeapon();
 
@@ -125,14 +151,14 @@ protected:
 	// Drops currently equipped weapon and equips TracehitItem
 	void SwapWeapon(AWeapon* WeaponToSwap);
 
-	// INitialize the ammo map with ammo values
-	void InitializeAmmoMap();
-
 	// Fire weapon functions!!!
 	void PlayFireSound();
 	void SendBullet();
 	void PlayGunfireMontage();
 
+	// Hands a simulated bullet to the projectile subsystem
+	void FireProjectile(const FTransform& SocketTransform);
+
 	// Bound to the R key and face button left
 	void ReloadButtonPressed();
 
@@ -165,22 +191,22 @@ protected:
 
 	void InitializeInterpLocations();
 
-	void OneKeyPressed();
-	void TwoKeyPressed();
-	void ThreeKeyPressed();
-	void FourKeyPressed();
-	void FiveKeyPressed();
-	void SixKeyPressed();
+	// "1Key" .. "NKey" pressed
+	void SlotKeyPressed(int32 Slot);
 
 	void ExchangeInventoryitems(int32 CurrentItemIndex, int32 NewitemIndex);
 
-	int32 GetEmptyInventorySlot();
+	// Forwards the inventory's merged equip notification to the inventory bar
+	void BroadcastEquipItem(int32 CurrentSlotIndex, int32 NewSlotIndex);
 
 	void HighlightInventorySlot();
 
 	UFUNCTION(BlueprintCallable)
 	EPhysicalSurface GetSurfaceType();
 
+	// Surface under us, from the movement component's floor
+	FGroundSurfaceCache GroundSurface;
+
 	UFUNCTION(BlueprintCallable)
 	void EndStun();
 
@@ -321,6 +347,9 @@ private:
 	// True if we should trace every frame for items
 	bool bShouldTraceForItems;
 
+	// while an item trace waits for budget no new one is submitted, until this time when it's dropped
+	float ItemTraceDeadlineTime;
+
 	// Number of overlapped AItems
 	int8 OverlappedItemCount;
 
@@ -328,6 +357,18 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
 	class AItem* TraceHitItemLastFrame;
 
+	// Pickup popup shared by every item, shown over whichever item we are looking at
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
+	class UWidgetComponent* PickupWidgetComponent;
+
+	// Widget class for the pickup popup, must be set in the character Blueprint or no prompt is shown
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<class UPickupWidget> PickupWidgetClass;
+
+	// Height of the pickup popup above the top of the item's collision box
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
+	float PickupWidgetHeight;
+
 	// Currently Equipped weapon...
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	AWeapon* EquippedWeapon;
@@ -348,17 +389,30 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
 		float CamerainterpElevation;
 
-	//Map to keep track of ammo of the different ammo types
+	// Number of interp anchors items fan out across when picked up
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true", ClampMin = "1", ClampMax = "256"))
+		int32 NumInterpAnchors;
+
+	// Distance outward from the camera to the item anchors
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
+		float ItemInterpDistance;
+
+	// Radius of the disc the item anchors are spread over
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
+		float ItemInterpRadius;
+
+	// Ammo carried for each ammo type
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
-		TMap<EAmmoType, int32> AmmoMap;
+		class UAmmoLedgerComponent* AmmoLedger;
 
-	// Starting amount of 9mm ammo
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
-		int32 Starting9mmAmmo;
+#if WITH_EDITORONLY_DATA
+	// Starting amounts from before the ammo ledger, moved into its StartingAmmo on load
+	UPROPERTY()
+		int32 Starting9mmAmmo_DEPRECATED;
 
-	// Starting amount of AR ammo
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
-		int32 StartingARAmmo;
+	UPROPERTY()
+		int32 StartingARAmmo_DEPRECATED;
+#endif
 
 	// check to make sure the weapon has ammo
 	bool WeaponHasAmmo();
@@ -423,31 +477,13 @@ private:
 	// used for knowing when the aiming button is pressed
 	bool bAimingButtonPressed;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* WeaponInterpComp;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp1;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp2;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp3;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp4;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp5;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp6;
-
-	// array of interp location structs.
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	// array of interp location structs, the weapon location first then one per item anchor
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 	TArray<FInterpLocation> InterpLocations;
 
+	// item anchors (InterpLocations 1..N) by how many items are flying to each
+	FInterpAnchorHeap InterpAnchorHeap;
+
 	FTimerHandle PickupSoundTimer;
 	FTimerHandle EquipSoundTimer;
 
@@ -464,11 +500,13 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
 	float EquipSoundResetTime;
 
-	// Array of AItems for our inventory
+	// Slots for the items we carry
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
-	TArray<AItem*> Inventory;
+	class UInventoryComponent* Inventory;
 
-	const int32 INVENTORY_CAPACITY{ 6 };
+	// Number of slots selectable with the "1Key" .. "NKey" actions
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true", ClampMin = "0", ClampMax = "10"))
+	int32 NumSlotKeys;
 
 	// Delegate for sending slot information to inventory bar when equipping
 	UPROPERTY(BlueprintAssignable, Category = Delegate, meta = (AllowPrivateAccess = "true"))
@@ -514,6 +552,17 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	bool bDead;
 
+	// Penetration depth, damage falloff and ricochet angle per physical surface
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "DataTable", meta = (AllowPrivateAccess = "true"))
+	class UDataTable* SurfacePenetrationDataTable;
+
+	// Max number of segments (penetrations + ricochets + 1) a single shot is traced through
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true", ClampMin = "1", ClampMax = "8"))
+	int32 MaxBulletSegments;
+
+	// Resolves the path of hitscan shots
+	FBulletTracer BulletTracer;
+
 public:
 	/** Returns CameraBoom subobject */
 	FORCEINLINE USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
@@ -540,6 +589,7 @@ public:
 	FORCEINLINE bool GetCrouching() const { return bCrouching; }
 
 	FInterpLocation GetInterpLocation(int32 Index);
+	FORCEINLINE const TArray<FInterpLocation>& GetInterpLocations() const { return InterpLocations; }
 
 	// Returns the index in interplocations array with the lowest item count.
 	int32 GetInterpLocationIndex();
@@ -556,6 +606,14 @@ public:
 
 	FORCEINLINE AWeapon* GetEquippedWeapon() const { return EquippedWeapon; }
 
+	FORCEINLINE UInventoryComponent* GetInventory() const { return Inventory; }
+
+	// Blueprint access to the items that used to be in the Inventory array
+	UFUNCTION(BlueprintPure, Category = Inventory)
+	TArray<AItem*> GetInventoryItems() const;
+
+	FORCEINLINE UAmmoLedgerComponent* GetAmmoLedger() const { return AmmoLedger; }
+
 	FORCEINLINE USoundCue* GetMeleeImpactSound() const { return MeleeImpactSound; }
 
 	FORCEINLINE UParticleSystem* GetBloodParticles() const { return BloodParticles; }
@@ -564,4 +622,19 @@ public:
 
 	FORCEINLINE float GetStunChance() const { return StunChance; }
 
+	// Applies bullet impact effects and damage, used by hitscan and simulated bullets
+	void ApplyBulletHit(const FHitResult& HitResult, float BodyDamage, float HeadshotDamage);
+
+	// Every bound action goes through here so replays can record and play it back, Action is an EReplayAction
+	void InputAction(int32 Action, bool bPressed);
+
+	// Replay playback in place of the bound axis
+	void ApplyReplayAxis(EReplayAxis Axis, float Value);
+
+	// Everything but the inventory items, those are saved by the snapshot subsystem
+	void SaveSnapshot(FPlayerSnapshot& OutSnapshot) const;
+
+	// Replaces the inventory with items from SpawnItem and equips the saved slot
+	void LoadSnapshot(const FPlayerSnapshot& Snapshot, TFunctionRef<AItem*(const FItemSnapshot&)> SpawnItem);
+
 };
\ No newline at end of file
@@ -2,4 +2,10 @@
 
 
 #include "ShooterGameModeBase.h"
+#include "ShooterHUD.h"
 
+AShooterGameModeBase::AShooterGameModeBase()
+{
+	// native HUD draws the floating hit numbers
+	HUDClass = AShooterHUD::StaticClass();
+}
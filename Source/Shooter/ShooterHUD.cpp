@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterHUD.h"
+#include "Engine/Canvas.h"
+#include "Engine/Font.h"
+#include "CanvasItem.h"
+#include "SceneView.h"
+
+AShooterHUD::AShooterHUD() :
+	HitNumberCapacity(128),
+	HitNumberLifetime(1.f),
+	HitNumberRise(60.f),
+	HitNumberFont(nullptr),
+	BodyShotColor(FLinearColor::White),
+	HeadshotColor(FLinearColor(1.f, 0.2f, 0.f)),
+	HeadshotScale(1.5f),
+	HitNumberTextCacheSize(512),
+	NextHitNumber(0)
+{
+}
+
+void AShooterHUD::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// allocate every slot up front, the buffer never grows
+	HitNumbers.SetNum(HitNumberCapacity);
+	ScreenPositions.SetNumZeroed(HitNumberCapacity);
+	HitNumberTexts.Reserve(HitNumberTextCacheSize);
+
+	if (HitNumberFont == nullptr && GEngine)
+	{
+		HitNumberFont = GEngine->GetMediumFont();
+	}
+}
+
+void AShooterHUD::DrawHUD()
+{
+	Super::DrawHUD();
+
+	DrawHitNumbers();
+}
+
+void AShooterHUD::AddHitNumber(int32 Value, const FVector& WorldLocation, bool bHeadshot)
+{
+	if (HitNumbers.Num() == 0) return;
+
+	// overwrite the oldest slot
+	FHitNumber& HitNumber{ HitNumbers[NextHitNumber] };
+	HitNumber.Value = Value;
+	HitNumber.WorldLocation = WorldLocation;
+	HitNumber.SpawnTime = GetWorld()->GetTimeSeconds();
+	HitNumber.bHeadshot = bHeadshot;
+	HitNumber.Text = GetHitNumberText(Value);
+
+	NextHitNumber = (NextHitNumber + 1) % HitNumbers.Num();
+}
+
+const FText& AShooterHUD::GetHitNumberText(int32 Value)
+{
+	if (const FText* Cached = HitNumberTexts.Find(Value))
+	{
+		return *Cached;
+	}
+
+	if (HitNumberTexts.Num() >= HitNumberTextCacheSize)
+	{
+		// slots still hold their own reference, so dropping the cache doesn't touch what's on screen
+		HitNumberTexts.Reset();
+	}
+	return HitNumberTexts.Add(Value, FText::AsNumber(Value));
+}
+
+void AShooterHUD::DrawHitNumbers()
+{
+	if (Canvas == nullptr || Canvas->SceneView == nullptr) return;
+
+	const float Now{ GetWorld()->GetTimeSeconds() };
+	const FMatrix ViewProjection{ Canvas->SceneView->ViewMatrices.GetViewProjectionMatrix() };
+	const FIntRect ViewRect{ 0, 0, static_cast<int32>(Canvas->ClipX), static_cast<int32>(Canvas->ClipY) };
+
+	// project every live number with the same view projection
+	bool bAnyVisible{ false };
+	for (int32 i = 0; i < HitNumbers.Num(); i++)
+	{
+		const FHitNumber& HitNumber{ HitNumbers[i] };
+		const float Age{ Now - HitNumber.SpawnTime };
+		ScreenPositions[i].X = -1.f;
+		if (HitNumber.SpawnTime < 0.f || Age > HitNumberLifetime) continue;
+
+		const FVector Location{ HitNumber.WorldLocation + FVector(0.f, 0.f, HitNumberRise * Age / HitNumberLifetime) };
+		FVector2D ScreenPosition;
+		if (FSceneView::ProjectWorldToScreen(Location, ViewRect, ViewProjection, ScreenPosition))
+		{
+			ScreenPositions[i] = ScreenPosition;
+			bAnyVisible = true;
+		}
+	}
+	if (!bAnyVisible) return;
+
+	// draw them all with one text item
+	FCanvasTextItem TextItem(FVector2D::ZeroVector, FText::GetEmpty(), HitNumberFont, BodyShotColor);
+	TextItem.bCentreX = true;
+	TextItem.bCentreY = true;
+	TextItem.EnableShadow(FLinearColor::Black);
+	for (int32 i = 0; i < HitNumbers.Num(); i++)
+	{
+		if (ScreenPositions[i].X < 0.f) continue;
+
+		const FHitNumber& HitNumber{ HitNumbers[i] };
+		const float Alpha{ 1.f - (Now - HitNumber.SpawnTime) / HitNumberLifetime };
+		FLinearColor Color{ HitNumber.bHeadshot ? HeadshotColor : BodyShotColor };
+		Color.A = Alpha;
+
+		TextItem.Position = ScreenPositions[i];
+		TextItem.Text = HitNumber.Text;
+		TextItem.SetColor(Color);
+		TextItem.Scale = FVector2D(HitNumber.bHeadshot ? HeadshotScale : 1.f);
+		Canvas->DrawItem(TextItem);
+	}
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/HUD.h"
+#include "ShooterHUD.generated.h"
+
+// One floating damage number
+struct FHitNumber
+{
+	int32 Value{ 0 };
+	FVector WorldLocation{ FVector::ZeroVector };
+	float SpawnTime{ -1.f };
+	bool bHeadshot{ false };
+
+	// text for Value, shared with every other number of the same value
+	FText Text;
+};
+
+/**
+ * Draws every floating damage number on the canvas.
+ * Numbers live in a fixed ring buffer; the oldest slot is recycled when it's full,
+ * so sustained fire into a crowd never creates widgets.
+ */
+UCLASS()
+class SHOOTER_API AShooterHUD : public AHUD
+{
+	GENERATED_BODY()
+
+public:
+	AShooterHUD();
+
+	virtual void DrawHUD() override;
+
+	// Show a damage number at a world location
+	void AddHitNumber(int32 Value, const FVector& WorldLocation, bool bHeadshot);
+
+protected:
+
+	virtual void BeginPlay() override;
+
+private:
+
+	// Project every live number in one pass, then draw them
+	void DrawHitNumbers();
+
+	// Formatted text for a damage value, built the first time the value is seen
+	const FText& GetHitNumberText(int32 Value);
+
+	// Max damage numbers on screen at once
+	UPROPERTY(EditDefaultsOnly, Category = "Hit Numbers", meta = (ClampMin = "1"))
+	int32 HitNumberCapacity;
+
+	// Seconds a number stays on screen
+	UPROPERTY(EditDefaultsOnly, Category = "Hit Numbers")
+	float HitNumberLifetime;
+
+	// How far a number drifts upward over its lifetime
+	UPROPERTY(EditDefaultsOnly, Category = "Hit Numbers")
+	float HitNumberRise;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hit Numbers")
+	class UFont* HitNumberFont;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hit Numbers")
+	FLinearColor BodyShotColor;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hit Numbers")
+	FLinearColor HeadshotColor;
+
+	// Text scale for headshot numbers
+	UPROPERTY(EditDefaultsOnly, Category = "Hit Numbers")
+	float HeadshotScale;
+
+	// Distinct damage values whose text is kept, the cache starts over once it is full
+	UPROPERTY(EditDefaultsOnly, Category = "Hit Numbers", meta = (ClampMin = "1"))
+	int32 HitNumberTextCacheSize;
+
+	// ring buffer of numbers, NextHitNumber is the slot written next
+	TArray<FHitNumber> HitNumbers;
+	int32 NextHitNumber;
+
+	// screen position of each slot this frame, X < 0 when not drawn
+	TArray<FVector2D> ScreenPositions;
+
+	// damage values repeat, so hits stop formatting (and allocating) text once the usual values are cached
+	TMap<int32, FText> HitNumberTexts;
+};
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterReplay.h"
+
+FName ShooterReplay::GetAxisName(EReplayAxis Axis)
+{
+	static const FName Names[]
+	{
+		TEXT("MoveForward"),
+		TEXT("MoveRight"),
+		TEXT("TurnRate"),
+		TEXT("LookUpRate"),
+		TEXT("Turn"),
+		TEXT("LookUp")
+	};
+	static_assert(UE_ARRAY_COUNT(Names) == static_cast<int32>(EReplayAxis::Max), "Missing replay axis name");
+	return Names[static_cast<int32>(Axis)];
+}
+
+FName ShooterReplay::GetActionName(EReplayAction Action)
+{
+	static const FName Names[]
+	{
+		TEXT("Jump"),
+		TEXT("FireButton"),
+		TEXT("AimingButton"),
+		TEXT("Select"),
+		TEXT("ReloadButton"),
+		TEXT("Crouch")
+	};
+	static_assert(UE_ARRAY_COUNT(Names) == static_cast<int32>(EReplayAction::FirstSlotKey), "Missing replay action name");
+
+	const int32 Index{ static_cast<int32>(Action) };
+	if (Index < UE_ARRAY_COUNT(Names))
+	{
+		return Names[Index];
+	}
+	// "1Key" for the first slot and so on
+	return FName(*FString::Printf(TEXT("%dKey"), Index - static_cast<int32>(EReplayAction::FirstSlotKey) + 1));
+}
+
+FArchive& operator<<(FArchive& Ar, FReplayFrame& Frame)
+{
+	Ar << Frame.DeltaTime;
+
+	uint8 AxisMask{ 0 };
+	if (Ar.IsSaving())
+	{
+		for (int32 i = 0; i < static_cast<int32>(EReplayAxis::Max); i++)
+		{
+			AxisMask |= Frame.Axes[i] != 0.f ? 1 << i : 0;
+		}
+	}
+	Ar << AxisMask;
+	for (int32 i = 0; i < static_cast<int32>(EReplayAxis::Max); i++)
+	{
+		if (AxisMask & (1 << i))
+		{
+			Ar << Frame.Axes[i];
+		}
+		else if (Ar.IsLoading())
+		{
+			Frame.Axes[i] = 0.f;
+		}
+	}
+
+	uint8 NumActions{ static_cast<uint8>(FMath::Min(Frame.Actions.Num(), 255)) };
+	Ar << NumActions;
+	if (Ar.IsLoading())
+	{
+		Frame.Actions.SetNum(NumActions);
+	}
+	for (int32 i = 0; i < NumActions; i++)
+	{
+		// action in the low 7 bits, pressed in the top bit
+		uint8 Packed{ static_cast<uint8>((Frame.Actions[i].Action & 0x7f) | (Frame.Actions[i].bPressed ? 0x80 : 0)) };
+		Ar << Packed;
+		Frame.Actions[i].Action = Packed & 0x7f;
+		Frame.Actions[i].bPressed = (Packed & 0x80) != 0;
+	}
+
+	int32 NumSpawns{ Frame.Spawns.Num() };
+	Ar << NumSpawns;
+	if (Ar.IsLoading())
+	{
+		Frame.Spawns.SetNum(NumSpawns);
+	}
+	for (FReplaySpawnEvent& Spawn : Frame.Spawns)
+	{
+		Ar << Spawn.ClassPath << Spawn.Location;
+	}
+	return Ar;
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Input axes recorded every frame, in the order they are bound
+enum class EReplayAxis : uint8
+{
+	MoveForward,
+	MoveRight,
+	TurnRate,
+	LookUpRate,
+	Turn,
+	LookUp,
+
+	Max
+};
+
+// Input actions; inventory slot keys follow FirstSlotKey
+enum class EReplayAction : uint8
+{
+	Jump,
+	FireButton,
+	AimingButton,
+	Select,
+	ReloadButton,
+	Crouch,
+
+	FirstSlotKey
+};
+
+namespace ShooterReplay
+{
+	// Axis and action names as set up in the project's input settings
+	SHOOTER_API FName GetAxisName(EReplayAxis Axis);
+	SHOOTER_API FName GetActionName(EReplayAction Action);
+
+	// "SHRP"
+	constexpr uint32 Magic{ 0x50524853 };
+	constexpr uint32 Version{ 1 };
+}
+
+struct FReplayHeader
+{
+	uint32 Magic{ ShooterReplay::Magic };
+	uint32 Version{ ShooterReplay::Version };
+
+	// session seed, everything random in gameplay derives from it
+	int32 Seed{ 0 };
+	FString MapName;
+
+	friend FArchive& operator<<(FArchive& Ar, FReplayHeader& Header)
+	{
+		Ar << Header.Magic << Header.Version << Header.Seed << Header.MapName;
+		return Ar;
+	}
+};
+
+struct FReplayActionEvent
+{
+	uint8 Action{ 0 };
+	bool bPressed{ false };
+};
+
+struct FReplaySpawnEvent
+{
+	FString ClassPath;
+	FVector3f Location{ FVector3f::ZeroVector };
+};
+
+// Everything needed to re-run one frame
+struct FReplayFrame
+{
+	float DeltaTime{ 0.f };
+	float Axes[static_cast<int32>(EReplayAxis::Max)]{};
+	TArray<FReplayActionEvent> Actions;
+	TArray<FReplaySpawnEvent> Spawns;
+
+	void Reset()
+	{
+		DeltaTime = 0.f;
+		FMemory::Memzero(Axes);
+		Actions.Reset();
+		Spawns.Reset();
+	}
+
+	// only non zero axes are written, most frames have little input
+	friend FArchive& operator<<(FArchive& Ar, FReplayFrame& Frame);
+};
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterSnapshot.h"
+#include "HAL/FileManager.h"
+#include "Serialization/MemoryWriter.h"
+
+FIntPoint ShooterSnapshot::GetRegion(const FVector3f& Location, float RegionSize)
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / RegionSize), FMath::FloorToInt(Location.Y / RegionSize));
+}
+
+void ShooterSnapshot::Write(FWorldSnapshot& Snapshot, float RegionSize, TArray<uint8>& OutBytes)
+{
+	FMemoryWriter Ar(OutBytes);
+
+	uint32 FileMagic{ Magic };
+	uint32 FileVersion{ Version };
+	Ar << FileMagic << FileVersion << Snapshot.MapName;
+
+	TArray<FSnapshotTocEntry> Entries;
+	const auto WriteChunk{ [&Ar, &Entries](uint32 Tag, const FIntPoint& Region, auto& Value)
+	{
+		FSnapshotTocEntry& Entry{ Entries.AddDefaulted_GetRef() };
+		Entry.Tag = Tag;
+		Entry.Version = Version;
+		Entry.Region = Region;
+		Entry.Offset = Ar.Tell();
+		Ar << Value;
+		Entry.Size = Ar.Tell() - Entry.Offset;
+	} };
+
+	WriteChunk(ClassesTag, FIntPoint::ZeroValue, Snapshot.ClassPaths);
+	if (Snapshot.bHasPlayer)
+	{
+		WriteChunk(PlayerTag, FIntPoint::ZeroValue, Snapshot.Player);
+	}
+	WriteChunk(EnemiesTag, FIntPoint::ZeroValue, Snapshot.Enemies);
+
+	// one chunk per region
+	TMap<FIntPoint, TArray<FItemSnapshot>> Regions;
+	for (const FItemSnapshot& Item : Snapshot.Items)
+	{
+		Regions.FindOrAdd(GetRegion(Item.Location, RegionSize)).Add(Item);
+	}
+	for (TPair<FIntPoint, TArray<FItemSnapshot>>& Region : Regions)
+	{
+		WriteChunk(ItemsTag, Region.Key, Region.Value);
+	}
+
+	int64 TocOffset{ Ar.Tell() };
+	Ar << Entries;
+	Ar << TocOffset;
+}
+
+bool FSnapshotReader::Open(const FString& Path)
+{
+	Reader.Reset(IFileManager::Get().CreateFileReader(*Path));
+	if (!Reader) return false;
+
+	uint32 FileMagic{ 0 };
+	uint32 FileVersion{ 0 };
+	*Reader << FileMagic << FileVersion;
+	if (Reader->IsError() || FileMagic != ShooterSnapshot::Magic || FileVersion != ShooterSnapshot::Version)
+	{
+		Reader.Reset();
+		return false;
+	}
+	*Reader << MapName;
+
+	// the footer points at the table of contents
+	int64 TocOffset{ 0 };
+	Reader->Seek(Reader->TotalSize() - sizeof(int64));
+	*Reader << TocOffset;
+	Reader->Seek(TocOffset);
+	*Reader << Entries;
+
+	if (Reader->IsError())
+	{
+		Reader.Reset();
+		return false;
+	}
+	return true;
+}
+
+const FSnapshotTocEntry* FSnapshotReader::FindEntry(uint32 Tag) const
+{
+	return Entries.FindByPredicate([Tag](const FSnapshotTocEntry& Entry) { return Entry.Tag == Tag; });
+}
+
+bool FSnapshotReader::ReadChunkBytes(const FSnapshotTocEntry& Entry, TArray<uint8>& OutBytes)
+{
+	if (!Reader || Entry.Size < 0 || Entry.Offset + Entry.Size > Reader->TotalSize()) return false;
+
+	OutBytes.SetNumUninitialized(Entry.Size);
+	Reader->Seek(Entry.Offset);
+	Reader->Serialize(OutBytes.GetData(), Entry.Size);
+	return !Reader->IsError();
+}
@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/MemoryReader.h"
+
+/**
+ * Save file layout:
+ *   header: magic, version, map name
+ *   chunks: tag specific payloads, each written as one block so it can be skipped or read on its own
+ *   table of contents: tag, chunk version, region, offset and size of every chunk
+ *   footer: offset of the table of contents
+ * Dropped items are split into one chunk per region so loads can bring them in as the player gets close.
+ * Readers skip tags they don't know and check each chunk's version.
+ */
+namespace ShooterSnapshot
+{
+	// "SHSV"
+	constexpr uint32 Magic{ 0x56534853 };
+	constexpr uint32 Version{ 2 };
+
+	constexpr uint32 MakeTag(char A, char B, char C, char D)
+	{
+		return static_cast<uint32>(A) | static_cast<uint32>(B) << 8 | static_cast<uint32>(C) << 16 | static_cast<uint32>(D) << 24;
+	}
+
+	// class paths the other chunks index into
+	constexpr uint32 ClassesTag{ MakeTag('C', 'L', 'S', 'S') };
+	constexpr uint32 PlayerTag{ MakeTag('P', 'L', 'Y', 'R') };
+	constexpr uint32 EnemiesTag{ MakeTag('E', 'N', 'M', 'Y') };
+	constexpr uint32 ItemsTag{ MakeTag('I', 'T', 'E', 'M') };
+}
+
+struct FItemSnapshot
+{
+	int32 ClassIndex{ INDEX_NONE };
+	FVector3f Location{ FVector3f::ZeroVector };
+	FQuat4f Rotation{ FQuat4f::Identity };
+	uint8 Rarity{ 0 };
+	int32 ItemCount{ 0 };
+	int32 SlotIndex{ INDEX_NONE };
+
+	// weapons only
+	uint8 WeaponType{ 0 };
+	int32 WeaponId{ INDEX_NONE };
+	int32 Ammo{ 0 };
+
+	friend FArchive& operator<<(FArchive& Ar, FItemSnapshot& Item)
+	{
+		Ar << Item.ClassIndex << Item.Location << Item.Rotation << Item.Rarity << Item.ItemCount << Item.SlotIndex;
+		Ar << Item.WeaponType << Item.WeaponId << Item.Ammo;
+		return Ar;
+	}
+};
+
+struct FPlayerSnapshot
+{
+	FVector Location{ FVector::ZeroVector };
+	FRotator ControlRotation{ FRotator::ZeroRotator };
+	float Health{ 0.f };
+	// indexed by EAmmoType
+	TArray<int32> Ammo;
+	TArray<FItemSnapshot> Inventory;
+	int32 EquippedSlot{ INDEX_NONE };
+
+	friend FArchive& operator<<(FArchive& Ar, FPlayerSnapshot& Player)
+	{
+		Ar << Player.Location << Player.ControlRotation << Player.Health << Player.Ammo << Player.Inventory << Player.EquippedSlot;
+		return Ar;
+	}
+};
+
+struct FEnemySnapshot
+{
+	// level placed enemies are matched by name, spawned ones are spawned again from their class
+	FName Name;
+	bool bLevelPlaced{ false };
+	int32 ClassIndex{ INDEX_NONE };
+	// wave spawner a spawned enemy came from, it's restored through that spawner's pool
+	FName Spawner;
+	FVector3f Location{ FVector3f::ZeroVector };
+	float Yaw{ 0.f };
+	float Health{ 0.f };
+	FVector3f PatrolPoint{ FVector3f::ZeroVector };
+	FVector3f PatrolPoint2{ FVector3f::ZeroVector };
+	bool bHasTarget{ false };
+
+	friend FArchive& operator<<(FArchive& Ar, FEnemySnapshot& Enemy)
+	{
+		Ar << Enemy.Name << Enemy.bLevelPlaced << Enemy.ClassIndex << Enemy.Spawner << Enemy.Location << Enemy.Yaw << Enemy.Health;
+		Ar << Enemy.PatrolPoint << Enemy.PatrolPoint2 << Enemy.bHasTarget;
+		return Ar;
+	}
+};
+
+// Everything a save holds, captured on the game thread and written out on a worker
+struct FWorldSnapshot
+{
+	FString MapName;
+	TArray<FString> ClassPaths;
+	bool bHasPlayer{ false };
+	FPlayerSnapshot Player;
+	TArray<FEnemySnapshot> Enemies;
+	// items lying in the world
+	TArray<FItemSnapshot> Items;
+};
+
+struct FSnapshotTocEntry
+{
+	uint32 Tag{ 0 };
+	uint32 Version{ 0 };
+	FIntPoint Region{ 0, 0 };
+	int64 Offset{ 0 };
+	int64 Size{ 0 };
+
+	friend FArchive& operator<<(FArchive& Ar, FSnapshotTocEntry& Entry)
+	{
+		Ar << Entry.Tag << Entry.Version << Entry.Region << Entry.Offset << Entry.Size;
+		return Ar;
+	}
+};
+
+namespace ShooterSnapshot
+{
+	// Region a world location falls in
+	SHOOTER_API FIntPoint GetRegion(const FVector3f& Location, float RegionSize);
+
+	// Serializes a snapshot to the save file layout, safe to call off the game thread
+	SHOOTER_API void Write(FWorldSnapshot& Snapshot, float RegionSize, TArray<uint8>& OutBytes);
+}
+
+/**
+ * Reads the header and table of contents of a save, then single chunks on request.
+ * The file stays open until the reader is destroyed.
+ */
+class SHOOTER_API FSnapshotReader
+{
+public:
+	bool Open(const FString& Path);
+
+	FORCEINLINE const FString& GetMapName() const { return MapName; }
+	FORCEINLINE const TArray<FSnapshotTocEntry>& GetEntries() const { return Entries; }
+
+	// First entry with a tag, null when the save has none
+	const FSnapshotTocEntry* FindEntry(uint32 Tag) const;
+
+	// Raw payload of a chunk, false on a read error
+	bool ReadChunkBytes(const FSnapshotTocEntry& Entry, TArray<uint8>& OutBytes);
+
+	// Payload of a chunk deserialized into Value, false on a read error or unsupported chunk version
+	template<typename T>
+	bool ReadChunk(const FSnapshotTocEntry& Entry, T& OutValue);
+
+private:
+	TUniquePtr<FArchive> Reader;
+	FString MapName;
+	TArray<FSnapshotTocEntry> Entries;
+};
+
+template<typename T>
+bool FSnapshotReader::ReadChunk(const FSnapshotTocEntry& Entry, T& OutValue)
+{
+	if (Entry.Version != ShooterSnapshot::Version) return false;
+
+	TArray<uint8> Bytes;
+	if (!ReadChunkBytes(Entry, Bytes)) return false;
+
+	FMemoryReader Ar(Bytes);
+	Ar << OutValue;
+	return !Ar.IsError();
+}
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterTimings.h"
+
+uint64 FShooterTimings::FrameCycles[static_cast<int32>(EShooterTiming::Max)] = {};
+
+const TCHAR* FShooterTimings::GetName(EShooterTiming Timing)
+{
+	switch (Timing)
+	{
+	case EShooterTiming::Projectiles:
+		return TEXT("Projectiles");
+	case EShooterTiming::DamageQueue:
+		return TEXT("DamageQueue");
+	case EShooterTiming::Explosions:
+		return TEXT("Explosions");
+	case EShooterTiming::PickupInterp:
+		return TEXT("PickupInterp");
+	case EShooterTiming::ItemSleep:
+		return TEXT("ItemSleep");
+	case EShooterTiming::TraceScheduler:
+		return TEXT("TraceScheduler");
+	case EShooterTiming::AssetStreaming:
+		return TEXT("AssetStreaming");
+	case EShooterTiming::AI:
+		return TEXT("AI");
+	}
+	return TEXT("Unknown");
+}
+
+FString FShooterTimings::GetCsvHeader()
+{
+	FString Header{ TEXT("Frame,DeltaMs") };
+	for (int32 i = 0; i < static_cast<int32>(EShooterTiming::Max); i++)
+	{
+		Header += TEXT(",");
+		Header += GetName(static_cast<EShooterTiming>(i));
+	}
+	return Header;
+}
+
+FString FShooterTimings::ConsumeCsvRow(uint32 Frame, float DeltaTime)
+{
+	FString Row{ FString::Printf(TEXT("%u,%.3f"), Frame, DeltaTime * 1000.f) };
+	for (uint64& Cycles : FrameCycles)
+	{
+		Row += FString::Printf(TEXT(",%.3f"), FPlatformTime::ToMilliseconds64(Cycles));
+		Cycles = 0;
+	}
+	return Row;
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Subsystems timed for the per-frame timing CSV
+enum class EShooterTiming : uint8
+{
+	Projectiles,
+	DamageQueue,
+	Explosions,
+	PickupInterp,
+	ItemSleep,
+	TraceScheduler,
+	AssetStreaming,
+	AI,
+
+	Max
+};
+
+/**
+ * Game thread time per subsystem, gathered every frame so replays can write it out.
+ * Unlike stats this is available in shipping and headless builds.
+ */
+struct SHOOTER_API FShooterTimings
+{
+	static FORCEINLINE void Add(EShooterTiming Timing, uint64 Cycles) { FrameCycles[static_cast<int32>(Timing)] += Cycles; }
+
+	static const TCHAR* GetName(EShooterTiming Timing);
+
+	// Header row for a timing CSV
+	static FString GetCsvHeader();
+
+	// One CSV row with this frame's milliseconds per subsystem, then starts the next frame
+	static FString ConsumeCsvRow(uint32 Frame, float DeltaTime);
+
+private:
+	static uint64 FrameCycles[static_cast<int32>(EShooterTiming::Max)];
+};
+
+// Adds the time until the end of the scope to a subsystem's timing
+struct FScopedShooterTiming
+{
+	explicit FScopedShooterTiming(EShooterTiming InTiming) :
+		Timing(InTiming),
+		StartCycles(FPlatformTime::Cycles64())
+	{
+	}
+
+	~FScopedShooterTiming()
+	{
+		FShooterTimings::Add(Timing, FPlatformTime::Cycles64() - StartCycles);
+	}
+
+private:
+	EShooterTiming Timing;
+	uint64 StartCycles;
+};
+
+#define SHOOTER_SCOPE_TIMING(Timing) FScopedShooterTiming PREPROCESSOR_JOIN(ShooterTiming, __LINE__)(EShooterTiming::Timing)
@@ -0,0 +1,426 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SnapshotSubsystem.h"
+#include "Async/Async.h"
+#include "EngineUtils.h"
+#include "HAL/FileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Enemy.h"
+#include "EnemyWaveSpawner.h"
+#include "InventoryComponent.h"
+#include "Item.h"
+#include "ShooterCharacter.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Snapshot Capture"), STAT_SnapshotCapture, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Snapshot Region Load"), STAT_SnapshotRegionLoad, STATGROUP_Shooter);
+
+USnapshotSubsystem::USnapshotSubsystem() :
+	AutosaveInterval(300.f),
+	AutosaveSlot(TEXT("Autosave")),
+	RegionSize(5000.f),
+	RegionLoadDistance(15000.f),
+	ItemSpawnsPerFrame(16),
+	TimeSinceAutosave(0.f),
+	NextRegionItem(0)
+{
+}
+
+void USnapshotSubsystem::Deinitialize()
+{
+	// don't leave a half written save behind
+	if (PendingSave.IsValid())
+	{
+		PendingSave.Wait();
+	}
+	Super::Deinitialize();
+}
+
+void USnapshotSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingSave.IsValid() && PendingSave.IsReady())
+	{
+		if (!PendingSave.Get())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Writing a snapshot failed"));
+		}
+		PendingSave.Reset();
+	}
+
+	if (IsStreamingItems())
+	{
+		StreamRegions();
+	}
+
+	if (AutosaveInterval > 0.f)
+	{
+		TimeSinceAutosave += DeltaTime;
+		if (TimeSinceAutosave >= AutosaveInterval && !IsSaving())
+		{
+			SaveSnapshot(AutosaveSlot);
+		}
+	}
+}
+
+TStatId USnapshotSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USnapshotSubsystem, STATGROUP_Tickables);
+}
+
+bool USnapshotSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+FString USnapshotSubsystem::GetSlotPath(const FString& SlotName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("SaveGames") / SlotName + TEXT(".snapshot");
+}
+
+bool USnapshotSubsystem::SaveSnapshot(const FString& SlotName)
+{
+	if (IsSaving()) return false;
+	TimeSinceAutosave = 0.f;
+
+	// items of regions not read yet belong in this save too, and the file may be the one replaced
+	ReadPendingRegions();
+
+	FWorldSnapshot Snapshot;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SnapshotCapture);
+		Snapshot.MapName = GetWorld()->GetMapName();
+		ClassIndices.Reset();
+		CapturePlayer(Snapshot);
+		CaptureEnemies(Snapshot);
+		CaptureItems(Snapshot);
+	}
+
+	// write next to the old save and swap it in, a crash mid write keeps the old one
+	const FString Path{ GetSlotPath(SlotName) };
+	PendingSave = Async(EAsyncExecution::ThreadPool, [Snapshot = MoveTemp(Snapshot), Path, Size = RegionSize]() mutable
+	{
+		TArray<uint8> Bytes;
+		ShooterSnapshot::Write(Snapshot, Size, Bytes);
+
+		const FString TempPath{ Path + TEXT(".tmp") };
+		return FFileHelper::SaveArrayToFile(Bytes, *TempPath) && IFileManager::Get().Move(*Path, *TempPath);
+	});
+	return true;
+}
+
+int32 USnapshotSubsystem::GetClassIndex(FWorldSnapshot& Snapshot, const UClass* Class)
+{
+	if (const int32* Index = ClassIndices.Find(Class))
+	{
+		return *Index;
+	}
+	const int32 Index{ Snapshot.ClassPaths.Add(Class->GetPathName()) };
+	ClassIndices.Add(Class, Index);
+	return Index;
+}
+
+void USnapshotSubsystem::CapturePlayer(FWorldSnapshot& Snapshot)
+{
+	const AShooterCharacter* Character{ Cast<AShooterCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0)) };
+	if (Character == nullptr) return;
+
+	Snapshot.bHasPlayer = true;
+	Character->SaveSnapshot(Snapshot.Player);
+
+	const UInventoryComponent* Inventory{ Character->GetInventory() };
+	for (int32 Slot = 0; Slot < Inventory->GetCapacity(); Slot++)
+	{
+		if (const AItem* Item = Inventory->GetItem(Slot))
+		{
+			FItemSnapshot& ItemSnapshot{ Snapshot.Player.Inventory.AddDefaulted_GetRef() };
+			Item->SaveSnapshot(ItemSnapshot);
+			ItemSnapshot.ClassIndex = GetClassIndex(Snapshot, Item->GetClass());
+		}
+	}
+}
+
+void USnapshotSubsystem::CaptureEnemies(FWorldSnapshot& Snapshot)
+{
+	for (TActorIterator<AEnemy> It(GetWorld()); It; ++It)
+	{
+		// the dead stay dead, pooled enemies aren't in the world yet
+		if (It->IsDying() || It->IsDormant()) continue;
+
+		FEnemySnapshot& EnemySnapshot{ Snapshot.Enemies.AddDefaulted_GetRef() };
+		It->SaveSnapshot(EnemySnapshot);
+		EnemySnapshot.ClassIndex = GetClassIndex(Snapshot, It->GetClass());
+	}
+}
+
+void USnapshotSubsystem::CaptureItems(FWorldSnapshot& Snapshot)
+{
+	for (TActorIterator<AItem> It(GetWorld()); It; ++It)
+	{
+		// held items are saved with the inventory
+		const EItemState State{ It->GetItemState() };
+		if (State != EItemState::EIS_Pickup && State != EItemState::EIS_Falling) continue;
+
+		FItemSnapshot& ItemSnapshot{ Snapshot.Items.AddDefaulted_GetRef() };
+		It->SaveSnapshot(ItemSnapshot);
+		ItemSnapshot.ClassIndex = GetClassIndex(Snapshot, It->GetClass());
+	}
+
+	// items still streaming in from the last load aren't in the world yet, carry them over
+	for (int32 i = NextRegionItem; i < RegionItems.Num(); i++)
+	{
+		CaptureLoadedItem(Snapshot, RegionItems[i]);
+	}
+	for (const FPendingRegion& PendingRegion : PendingRegions)
+	{
+		for (const FItemSnapshot& Item : PendingRegion.Items)
+		{
+			CaptureLoadedItem(Snapshot, Item);
+		}
+	}
+}
+
+void USnapshotSubsystem::CaptureLoadedItem(FWorldSnapshot& Snapshot, const FItemSnapshot& Item)
+{
+	// indices point into the loaded save's class table, not the one being written
+	const UClass* Class{ LoadedClasses.IsValidIndex(Item.ClassIndex) ? LoadedClasses[Item.ClassIndex] : nullptr };
+	if (Class == nullptr) return;
+
+	FItemSnapshot& ItemSnapshot{ Snapshot.Items.Add_GetRef(Item) };
+	ItemSnapshot.ClassIndex = GetClassIndex(Snapshot, Class);
+}
+
+void USnapshotSubsystem::ReadPendingRegions()
+{
+	if (Reader == nullptr) return;
+
+	for (FPendingRegion& PendingRegion : PendingRegions)
+	{
+		if (!Reader->ReadChunk(PendingRegion.Entry, PendingRegion.Items))
+		{
+			PendingRegion.Items.Reset();
+		}
+	}
+	Reader.Reset();
+}
+
+bool USnapshotSubsystem::LoadSnapshot(const FString& SlotName)
+{
+	TUniquePtr<FSnapshotReader> NewReader{ MakeUnique<FSnapshotReader>() };
+	if (!NewReader->Open(GetSlotPath(SlotName)))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not open snapshot %s"), *SlotName);
+		return false;
+	}
+	if (NewReader->GetMapName() != GetWorld()->GetMapName())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot %s was saved on %s"), *SlotName, *NewReader->GetMapName());
+		return false;
+	}
+
+	TArray<FString> ClassPaths;
+	const FSnapshotTocEntry* ClassesEntry{ NewReader->FindEntry(ShooterSnapshot::ClassesTag) };
+	if (ClassesEntry == nullptr || !NewReader->ReadChunk(*ClassesEntry, ClassPaths))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot %s has no class table"), *SlotName);
+		return false;
+	}
+
+	FPlayerSnapshot Player;
+	const FSnapshotTocEntry* PlayerEntry{ NewReader->FindEntry(ShooterSnapshot::PlayerTag) };
+	const bool bHasPlayer{ PlayerEntry && NewReader->ReadChunk(*PlayerEntry, Player) };
+
+	TArray<FEnemySnapshot> Enemies;
+	const FSnapshotTocEntry* EnemiesEntry{ NewReader->FindEntry(ShooterSnapshot::EnemiesTag) };
+	const bool bHasEnemies{ EnemiesEntry && NewReader->ReadChunk(*EnemiesEntry, Enemies) };
+
+	// item regions stay in the file until the player gets near them
+	PendingRegions.Reset();
+	for (const FSnapshotTocEntry& Entry : NewReader->GetEntries())
+	{
+		if (Entry.Tag == ShooterSnapshot::ItemsTag)
+		{
+			PendingRegions.AddDefaulted_GetRef().Entry = Entry;
+		}
+	}
+	Reader.Reset();
+	if (PendingRegions.Num() > 0)
+	{
+		Reader = MoveTemp(NewReader);
+	}
+	RegionItems.Reset();
+	NextRegionItem = 0;
+
+	LoadedClasses.Reset();
+	for (const FString& ClassPath : ClassPaths)
+	{
+		LoadedClasses.Add(FSoftClassPath(ClassPath).TryLoadClass<AActor>());
+	}
+
+	// dropped items come back from the save, region by region
+	for (TActorIterator<AItem> It(GetWorld()); It; ++It)
+	{
+		const EItemState State{ It->GetItemState() };
+		if (State == EItemState::EIS_Pickup || State == EItemState::EIS_Falling)
+		{
+			It->Destroy();
+		}
+	}
+
+	if (bHasPlayer)
+	{
+		LoadPlayer(Player);
+	}
+	if (bHasEnemies)
+	{
+		LoadEnemies(Enemies);
+	}
+	TimeSinceAutosave = 0.f;
+	return true;
+}
+
+void USnapshotSubsystem::LoadPlayer(const FPlayerSnapshot& Player)
+{
+	AShooterCharacter* Character{ Cast<AShooterCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0)) };
+	if (Character == nullptr) return;
+
+	Character->LoadSnapshot(Player, [this](const FItemSnapshot& ItemSnapshot) { return SpawnItem(ItemSnapshot); });
+}
+
+void USnapshotSubsystem::LoadEnemies(const TArray<FEnemySnapshot>& Enemies)
+{
+	// level placed enemies are still in the world unless they were killed and destroyed
+	TMap<FName, AEnemy*> LevelEnemies;
+	TArray<AEnemy*> SpawnedEnemies;
+	for (TActorIterator<AEnemy> It(GetWorld()); It; ++It)
+	{
+		if (It->IsDormant()) continue;
+		if (It->HasAnyFlags(RF_WasLoaded))
+		{
+			LevelEnemies.Add(It->GetFName(), *It);
+		}
+		else
+		{
+			SpawnedEnemies.Add(*It);
+		}
+	}
+
+	// runtime enemies are all respawned from the save, pooled ones go back to their spawner
+	for (AEnemy* Enemy : SpawnedEnemies)
+	{
+		Enemy->Despawn();
+	}
+
+	TMap<FName, AEnemyWaveSpawner*> Spawners;
+	for (TActorIterator<AEnemyWaveSpawner> It(GetWorld()); It; ++It)
+	{
+		Spawners.Add(It->GetFName(), *It);
+	}
+
+	for (const FEnemySnapshot& EnemySnapshot : Enemies)
+	{
+		AEnemy* Enemy{ nullptr };
+		if (EnemySnapshot.bLevelPlaced)
+		{
+			// killed since the save, a corpse gets up again and a destroyed one is spawned below
+			LevelEnemies.RemoveAndCopyValue(EnemySnapshot.Name, Enemy);
+			if (Enemy && Enemy->IsDying())
+			{
+				Enemy->Revive();
+			}
+		}
+		else if (AEnemyWaveSpawner* const* Spawner = Spawners.Find(EnemySnapshot.Spawner))
+		{
+			// back out of the pool so it returns there when it dies again
+			const FTransform Transform{ FRotator(0.f, EnemySnapshot.Yaw, 0.f), FVector(EnemySnapshot.Location) };
+			Enemy = (*Spawner)->SpawnEnemy(Transform);
+		}
+
+		UClass* Class{ LoadedClasses.IsValidIndex(EnemySnapshot.ClassIndex) ? LoadedClasses[EnemySnapshot.ClassIndex] : nullptr };
+		if (Enemy == nullptr && Class)
+		{
+			FActorSpawnParameters Params;
+			Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+			Enemy = GetWorld()->SpawnActor<AEnemy>(Class, FVector(EnemySnapshot.Location), FRotator(0.f, EnemySnapshot.Yaw, 0.f), Params);
+		}
+
+		if (Enemy)
+		{
+			Enemy->LoadSnapshot(EnemySnapshot);
+		}
+	}
+
+	// level placed enemies left over were dead when the save was made
+	for (const TPair<FName, AEnemy*>& Pair : LevelEnemies)
+	{
+		Pair.Value->Destroy();
+	}
+}
+
+AItem* USnapshotSubsystem::SpawnItem(const FItemSnapshot& Snapshot)
+{
+	UClass* Class{ LoadedClasses.IsValidIndex(Snapshot.ClassIndex) ? LoadedClasses[Snapshot.ClassIndex] : nullptr };
+	if (Class == nullptr || !Class->IsChildOf<AItem>()) return nullptr;
+
+	const FTransform Transform{ FQuat(Snapshot.Rotation), FVector(Snapshot.Location) };
+	AItem* Item{ GetWorld()->SpawnActorDeferred<AItem>(Class, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn) };
+	if (Item == nullptr) return nullptr;
+
+	Item->LoadSnapshotDefaults(Snapshot);
+	UGameplayStatics::FinishSpawningActor(Item, Transform);
+	Item->LoadSnapshot(Snapshot);
+	return Item;
+}
+
+void USnapshotSubsystem::StreamRegions()
+{
+	SCOPE_CYCLE_COUNTER(STAT_SnapshotRegionLoad);
+
+	const APawn* Pawn{ UGameplayStatics::GetPlayerPawn(this, 0) };
+	if (Pawn == nullptr) return;
+	const FVector2D PlayerLocation{ Pawn->GetActorLocation() };
+
+	int32 Budget{ ItemSpawnsPerFrame };
+	while (Budget > 0)
+	{
+		// finish the region being spawned before starting the next
+		if (NextRegionItem < RegionItems.Num())
+		{
+			if (AItem* Item = SpawnItem(RegionItems[NextRegionItem]))
+			{
+				Item->SetItemState(EItemState::EIS_Pickup);
+			}
+			NextRegionItem++;
+			Budget--;
+			continue;
+		}
+
+		const int32 RegionIndex{ PendingRegions.IndexOfByPredicate([this, &PlayerLocation](const FPendingRegion& PendingRegion)
+		{
+			const FVector2D Center{ (FVector2D(PendingRegion.Entry.Region) + 0.5f) * RegionSize };
+			return FVector2D::DistSquared(Center, PlayerLocation) <= FMath::Square(RegionLoadDistance);
+		}) };
+		if (RegionIndex == INDEX_NONE) break;
+
+		RegionItems = MoveTemp(PendingRegions[RegionIndex].Items);
+		NextRegionItem = 0;
+		if (Reader && !Reader->ReadChunk(PendingRegions[RegionIndex].Entry, RegionItems))
+		{
+			RegionItems.Reset();
+		}
+		PendingRegions.RemoveAtSwap(RegionIndex);
+	}
+
+	// everything is in, let go of the file and the class table
+	if (!IsStreamingItems())
+	{
+		Reader.Reset();
+		LoadedClasses.Reset();
+		RegionItems.Reset();
+		NextRegionItem = 0;
+	}
+}
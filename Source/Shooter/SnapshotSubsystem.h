@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterSnapshot.h"
+#include "SnapshotSubsystem.generated.h"
+
+class AItem;
+
+// Dropped items of one region of a save that haven't been spawned yet
+struct FPendingRegion
+{
+	FSnapshotTocEntry Entry;
+	// empty until read, either when the player gets near or when a save needs them
+	TArray<FItemSnapshot> Items;
+};
+
+/**
+ * Saves and loads the combat state of a world: the player, enemies and dropped items.
+ * Saving only copies state into plain structs on the game thread, serialization and file
+ * writes happen on a worker. Loading applies the player and enemies straight away and reads
+ * and spawns dropped items region by region as the player gets near them, a few per frame.
+ * A save made while regions are still pending reads the rest and closes the old file first,
+ * so the items not spawned yet are written again and the old file can be replaced.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API USnapshotSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	USnapshotSubsystem();
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Starts writing a save, false while the previous one is still being written
+	UFUNCTION(BlueprintCallable, Category = Snapshot)
+	bool SaveSnapshot(const FString& SlotName);
+
+	// Restores a save made on this map, dropped items keep streaming in after this returns
+	UFUNCTION(BlueprintCallable, Category = Snapshot)
+	bool LoadSnapshot(const FString& SlotName);
+
+	FORCEINLINE bool IsSaving() const { return PendingSave.IsValid(); }
+	FORCEINLINE int32 GetNumPendingRegions() const { return PendingRegions.Num(); }
+	FORCEINLINE bool IsStreamingItems() const { return PendingRegions.Num() > 0 || NextRegionItem < RegionItems.Num(); }
+
+private:
+	static FString GetSlotPath(const FString& SlotName);
+
+	// Index of a class in the snapshot's class table, adding it on first use
+	int32 GetClassIndex(FWorldSnapshot& Snapshot, const UClass* Class);
+
+	void CapturePlayer(FWorldSnapshot& Snapshot);
+	void CaptureEnemies(FWorldSnapshot& Snapshot);
+	void CaptureItems(FWorldSnapshot& Snapshot);
+
+	// Adds an item read by the last load that hasn't been spawned yet
+	void CaptureLoadedItem(FWorldSnapshot& Snapshot, const FItemSnapshot& Item);
+
+	// Reads every region still pending into memory and closes the save being loaded
+	void ReadPendingRegions();
+
+	void LoadPlayer(const FPlayerSnapshot& Player);
+	void LoadEnemies(const TArray<FEnemySnapshot>& Enemies);
+
+	// Spawns an item deferred so its defaults are set before construction, null when its class is gone
+	AItem* SpawnItem(const FItemSnapshot& Snapshot);
+
+	// Spawns items of regions close to the player within this frame's budget
+	void StreamRegions();
+
+	// Seconds between autosaves, 0 turns autosave off
+	UPROPERTY(Config)
+	float AutosaveInterval;
+
+	UPROPERTY(Config)
+	FString AutosaveSlot;
+
+	// Width of the square regions dropped items are saved and loaded in
+	UPROPERTY(Config)
+	float RegionSize;
+
+	// Regions closer than this to the player are loaded
+	UPROPERTY(Config)
+	float RegionLoadDistance;
+
+	// Items spawned per frame while regions stream in
+	UPROPERTY(Config)
+	int32 ItemSpawnsPerFrame;
+
+	float TimeSinceAutosave;
+
+	// result of the save being written on a worker
+	TFuture<bool> PendingSave;
+
+	// capture only, maps classes to their index in the class table
+	TMap<const UClass*, int32> ClassIndices;
+
+	// load state, kept while regions are still streaming in; the reader is closed once
+	// every pending region has been read
+	TUniquePtr<FSnapshotReader> Reader;
+	UPROPERTY()
+	TArray<UClass*> LoadedClasses;
+	TArray<FPendingRegion> PendingRegions;
+	TArray<FItemSnapshot> RegionItems;
+	int32 NextRegionItem;
+};
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TraceSchedulerSubsystem.h"
+#include "Engine/World.h"
+#include "Misc/MemStack.h"
+#include "Shooter.h"
+#include "ShooterTimings.h"
+
+DECLARE_CYCLE_STAT(TEXT("Trace Scheduler Queue"), STAT_TraceSchedulerQueue, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Combat Traces"), STAT_CombatTraces, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Traces"), STAT_AITraces, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Interaction Traces"), STAT_InteractionTraces, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cosmetic Traces"), STAT_CosmeticTraces, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Deferred Traces"), STAT_DeferredTraces, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dropped Traces"), STAT_DroppedTraces, STATGROUP_Shooter);
+
+UTraceSchedulerSubsystem::UTraceSchedulerSubsystem() :
+	MaxTracesPerFrame(128),
+	NumTracesThisFrame(0)
+{
+}
+
+void UTraceSchedulerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SHOOTER_SCOPE_TIMING(TraceScheduler);
+
+	if (Queue.Num() > 0)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_TraceSchedulerQueue);
+
+		const float Now{ GetWorld()->GetTimeSeconds() };
+		Queue.RemoveAll([this, Now](const FQueuedTrace& Trace)
+		{
+			if (Trace.DeadlineTime >= Now) return false;
+			FrameStats[static_cast<int32>(Trace.Request.Category)].Dropped++;
+			return true;
+		});
+
+		// the frame's leftover budget goes to the most urgent queued traces
+		Queue.StableSort([](const FQueuedTrace& A, const FQueuedTrace& B)
+		{
+			return A.Request.Category != B.Request.Category ?
+				A.Request.Category < B.Request.Category :
+				A.DeadlineTime < B.DeadlineTime;
+		});
+
+		const int32 NumReady{ FMath::Clamp(MaxTracesPerFrame - NumTracesThisFrame, 0, Queue.Num()) };
+		if (NumReady > 0)
+		{
+			// move them out first, callbacks may submit more traces
+			FMemMark Mark(FMemStack::Get());
+			TArray<FQueuedTrace, TMemStackAllocator<>> Ready;
+			Ready.Reserve(NumReady);
+			for (int32 i = 0; i < NumReady; i++)
+			{
+				Ready.Add(MoveTemp(Queue[i]));
+			}
+			Queue.RemoveAt(0, NumReady, false);
+
+			for (FQueuedTrace& Trace : Ready)
+			{
+				FHitResult Hit;
+				RunTrace(Trace.Request, Hit);
+				Trace.OnDone.ExecuteIfBound(Hit);
+			}
+		}
+	}
+
+	int32 Deferred{ 0 };
+	int32 Dropped{ 0 };
+	for (int32 i = 0; i < static_cast<int32>(ETraceCategory::Max); i++)
+	{
+		LastFrameStats[i] = FrameStats[i];
+		Deferred += FrameStats[i].Deferred;
+		Dropped += FrameStats[i].Dropped;
+		FrameStats[i] = FTraceCategoryStats();
+	}
+	SET_DWORD_STAT(STAT_CombatTraces, LastFrameStats[static_cast<int32>(ETraceCategory::Combat)].Issued);
+	SET_DWORD_STAT(STAT_AITraces, LastFrameStats[static_cast<int32>(ETraceCategory::AI)].Issued);
+	SET_DWORD_STAT(STAT_InteractionTraces, LastFrameStats[static_cast<int32>(ETraceCategory::Interaction)].Issued);
+	SET_DWORD_STAT(STAT_CosmeticTraces, LastFrameStats[static_cast<int32>(ETraceCategory::Cosmetic)].Issued);
+	SET_DWORD_STAT(STAT_DeferredTraces, Deferred);
+	SET_DWORD_STAT(STAT_DroppedTraces, Dropped);
+
+	NumTracesThisFrame = 0;
+}
+
+TStatId UTraceSchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTraceSchedulerSubsystem, STATGROUP_Tickables);
+}
+
+bool UTraceSchedulerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UTraceSchedulerSubsystem::TraceNow(const FTraceRequest& Request, FHitResult& OutHit)
+{
+	if (Request.Category != ETraceCategory::Combat && NumTracesThisFrame >= MaxTracesPerFrame)
+	{
+		FrameStats[static_cast<int32>(Request.Category)].Dropped++;
+		return false;
+	}
+
+	RunTrace(Request, OutHit);
+	return true;
+}
+
+void UTraceSchedulerSubsystem::Submit(const FTraceRequest& Request, FTraceDoneDelegate OnDone)
+{
+	if (Request.Category == ETraceCategory::Combat || NumTracesThisFrame < MaxTracesPerFrame)
+	{
+		FHitResult Hit;
+		RunTrace(Request, Hit);
+		OnDone.ExecuteIfBound(Hit);
+		return;
+	}
+
+	FQueuedTrace& Trace{ Queue.AddDefaulted_GetRef() };
+	Trace.Request = Request;
+	Trace.OnDone = MoveTemp(OnDone);
+	Trace.DeadlineTime = GetWorld()->GetTimeSeconds() + Request.Deadline;
+	FrameStats[static_cast<int32>(Request.Category)].Deferred++;
+}
+
+void UTraceSchedulerSubsystem::AddTraces(ETraceCategory Category, int32 NumTraces)
+{
+	NumTracesThisFrame += NumTraces;
+	FrameStats[static_cast<int32>(Category)].Issued += NumTraces;
+}
+
+bool UTraceSchedulerSubsystem::TraceNow(const UObject* WorldContext, const FTraceRequest& Request, FHitResult& OutHit)
+{
+	UWorld* World{ WorldContext ? WorldContext->GetWorld() : nullptr };
+	if (World == nullptr) return false;
+
+	if (UTraceSchedulerSubsystem* Scheduler = World->GetSubsystem<UTraceSchedulerSubsystem>())
+	{
+		return Scheduler->TraceNow(Request, OutHit);
+	}
+	World->LineTraceSingleByChannel(OutHit, Request.Start, Request.End, Request.Channel, Request.QueryParams);
+	return true;
+}
+
+void UTraceSchedulerSubsystem::Submit(const UObject* WorldContext, const FTraceRequest& Request, FTraceDoneDelegate OnDone)
+{
+	UWorld* World{ WorldContext ? WorldContext->GetWorld() : nullptr };
+	if (World == nullptr) return;
+
+	if (UTraceSchedulerSubsystem* Scheduler = World->GetSubsystem<UTraceSchedulerSubsystem>())
+	{
+		Scheduler->Submit(Request, MoveTemp(OnDone));
+		return;
+	}
+	FHitResult Hit;
+	World->LineTraceSingleByChannel(Hit, Request.Start, Request.End, Request.Channel, Request.QueryParams);
+	OnDone.ExecuteIfBound(Hit);
+}
+
+void UTraceSchedulerSubsystem::AddTraces(const UObject* WorldContext, ETraceCategory Category, int32 NumTraces)
+{
+	UWorld* World{ WorldContext ? WorldContext->GetWorld() : nullptr };
+	if (UTraceSchedulerSubsystem* Scheduler = World ? World->GetSubsystem<UTraceSchedulerSubsystem>() : nullptr)
+	{
+		Scheduler->AddTraces(Category, NumTraces);
+	}
+}
+
+void UTraceSchedulerSubsystem::RunTrace(const FTraceRequest& Request, FHitResult& OutHit)
+{
+	GetWorld()->LineTraceSingleByChannel(OutHit, Request.Start, Request.End, Request.Channel, Request.QueryParams);
+	NumTracesThisFrame++;
+	FrameStats[static_cast<int32>(Request.Category)].Issued++;
+}
@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CollisionQueryParams.h"
+#include "TraceSchedulerSubsystem.generated.h"
+
+// Trace categories in priority order, lower runs first
+enum class ETraceCategory : uint8
+{
+	// shots, bullet sweeps, explosion occlusion and aiming, never deferred or dropped
+	Combat,
+	AI,
+	// item focus under the crosshairs
+	Interaction,
+	// footstep surfaces and other effects
+	Cosmetic,
+
+	Max
+};
+
+// One line trace
+struct FTraceRequest
+{
+	ETraceCategory Category{ ETraceCategory::Interaction };
+	FVector Start{ FVector::ZeroVector };
+	FVector End{ FVector::ZeroVector };
+	ECollisionChannel Channel{ ECC_Visibility };
+	FCollisionQueryParams QueryParams;
+
+	// seconds a submitted trace may wait before it is dropped
+	float Deadline{ 0.1f };
+};
+
+// Traces run and turned away by one category in the last frame
+struct FTraceCategoryStats
+{
+	int32 Issued{ 0 };
+	int32 Deferred{ 0 };
+	int32 Dropped{ 0 };
+};
+
+DECLARE_DELEGATE_OneParam(FTraceDoneDelegate, const FHitResult&);
+
+/**
+ * Per-frame budget for line traces.
+ * Combat traces always run straight away; everything else runs while the frame's budget lasts.
+ * Over budget TraceNow turns a trace away, Submit queues it to be served by priority then
+ * deadline, and drops it once its deadline passes. Combat code that batches its own queries
+ * reports them through AddTraces, so they count against the budget and show in the stats.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UTraceSchedulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UTraceSchedulerSubsystem();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Run the trace now if the budget allows, returns false without tracing when it doesn't
+	bool TraceNow(const FTraceRequest& Request, FHitResult& OutHit);
+
+	// Run the trace once there is budget, OnDone is not called if it is dropped
+	void Submit(const FTraceRequest& Request, FTraceDoneDelegate OnDone);
+
+	// Count traces the caller ran itself, e.g. from a parallel batch
+	void AddTraces(ETraceCategory Category, int32 NumTraces);
+
+	FORCEINLINE const FTraceCategoryStats& GetCategoryStats(ETraceCategory Category) const { return LastFrameStats[static_cast<int32>(Category)]; }
+
+	// Trace through the world's scheduler, or straight through the world when there is none
+	static bool TraceNow(const UObject* WorldContext, const FTraceRequest& Request, FHitResult& OutHit);
+	static void Submit(const UObject* WorldContext, const FTraceRequest& Request, FTraceDoneDelegate OnDone);
+	static void AddTraces(const UObject* WorldContext, ETraceCategory Category, int32 NumTraces);
+
+private:
+
+	struct FQueuedTrace
+	{
+		FTraceRequest Request;
+		FTraceDoneDelegate OnDone;
+		float DeadlineTime{ 0.f };
+	};
+
+	void RunTrace(const FTraceRequest& Request, FHitResult& OutHit);
+
+	// Traces per frame for everything but combat, combat traces still count against it
+	UPROPERTY(Config)
+	int32 MaxTracesPerFrame;
+
+	TArray<FQueuedTrace> Queue;
+
+	// traces run so far this frame
+	int32 NumTracesThisFrame;
+
+	FTraceCategoryStats FrameStats[static_cast<int32>(ETraceCategory::Max)];
+	FTraceCategoryStats LastFrameStats[static_cast<int32>(ETraceCategory::Max)];
+};
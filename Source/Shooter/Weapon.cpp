@@ -2,15 +2,23 @@
 
 
 #include "Weapon.h"
+#include "Components/SphereComponent.h"
+#include "ShooterCharacter.h"
+#include "WeaponAssetStreamer.h"
+#include "CurveBakeSubsystem.h"
+#include "WeaponDefinition.h"
+#include "WeaponRegistry.h"
+#include "ShooterSnapshot.h"
 
 
 
 AWeapon::AWeapon() :
-	ThrowWeaponTime(0.7f),
+	ThrowWeaponTime(5.f),
 	bFalling(false),
 	Ammo(30),
 	MagazineCapacity(30),
 	WeaponType(EWeaponType::EWT_SubmachineGun),
+	WeaponId(INDEX_NONE),
 	AmmoType(EAmmoType::EAT_9mm),
 	ReloadMontageSection(FName(TEXT("Reload SMG"))),
 	ClipBoneName(TEXT("smg_clip")),
@@ -19,7 +27,13 @@ AWeapon::AWeapon() :
 	bMovingSlide(false),
 	MaxSlideDisplacement(4.f),
 	MaxRecoilRotation(20.f),
-	bAutomatic(true)
+	bAutomatic(true),
+	bProjectile(false),
+	MuzzleVelocity(40'000.f),
+	BulletGravityScale(1.f),
+	BulletDrag(0.f),
+	bPlayerInAssetRange(false),
+	bStreamedAssetsInUse(false)
 {
 	PrimaryActorTick.bCanEverTick = true;
 }
@@ -28,12 +42,6 @@ void AWeapon::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	// Keep the weapon upright
-	if (GetItemState() == EItemState::EIS_Falling && bFalling)
-	{
-		const FRotator MeshRotation{ 0.f, GetItemMesh()->GetComponentRotation().Yaw, 0.f };
-		GetItemMesh()->SetWorldRotation(MeshRotation, false, nullptr, ETeleportType::TeleportPhysics);
-	}
 	// UpdateSlide on Pistol
 	UpdateSlideDisplacement();
 }
@@ -49,7 +57,8 @@ void AWeapon::ThrowWeapon()
 	FVector ImpulseDirection = MeshRight.RotateAngleAxis(-20.f, MeshForward);
 	ImpulseDirection *= 20'000.f;
 
-	float RandomRotation = FMath::RandRange(30.f, 50.f);
+	// roll and pitch are locked in the physics body to keep the weapon upright, it goes back to pickup when the body sleeps
+	SetUprightLock(true);
 	GetItemMesh()->AddImpulse(ImpulseDirection);
 
 	bFalling = true;
@@ -58,77 +67,139 @@ void AWeapon::ThrowWeapon()
 	EnableGlowMaterial();
 }
 
+void AWeapon::SaveSnapshot(FItemSnapshot& OutSnapshot) const
+{
+	Super::SaveSnapshot(OutSnapshot);
+	OutSnapshot.WeaponType = static_cast<uint8>(WeaponType);
+	OutSnapshot.WeaponId = WeaponId;
+	OutSnapshot.Ammo = Ammo;
+}
+
+void AWeapon::LoadSnapshotDefaults(const FItemSnapshot& Snapshot)
+{
+	Super::LoadSnapshotDefaults(Snapshot);
+	// picks the data table row or definition OnConstruction builds from
+	WeaponType = static_cast<EWeaponType>(Snapshot.WeaponType);
+	WeaponId = Snapshot.WeaponId;
+}
+
+void AWeapon::LoadSnapshot(const FItemSnapshot& Snapshot)
+{
+	Super::LoadSnapshot(Snapshot);
+	// OnConstruction filled the magazine
+	Ammo = FMath::Clamp(Snapshot.Ammo, 0, MagazineCapacity);
+}
+
 void AWeapon::StopFalling()
 {
+	GetWorldTimerManager().ClearTimer(ThrowWeaponTimer);
+	SetUprightLock(false);
 	bFalling = false;
+
+	// picked up again before it settled
+	if (GetItemState() != EItemState::EIS_Falling) return;
+
 	SetItemState(EItemState::EIS_Pickup);
 	StartPulseTimer();
 }
 
+void AWeapon::OnMeshSleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	// settled, pick up where it landed
+	if (bFalling)
+	{
+		StopFalling();
+	}
+}
+
+void AWeapon::SetUprightLock(bool bLock)
+{
+	FBodyInstance* Body{ GetItemMesh()->GetBodyInstance() };
+	if (Body == nullptr) return;
+
+	Body->bGenerateWakeEvents = bLock;
+	Body->bLockXRotation = bLock;
+	Body->bLockYRotation = bLock;
+	Body->SetDOFLock(bLock ? EDOFMode::SixDOF : EDOFMode::None);
+}
+
 void AWeapon::OnConstruction(const FTransform& Transform)
 {
 
 	Super::OnConstruction(Transform);
-	const FString WeaponTablePath{ TEXT("/Script/Engine.DataTable'/Game/_Game/DataTables/WeaponDataTable.WeaponDataTable'") };
-	UDataTable* WeaponTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *WeaponTablePath));
-	if (WeaponTableObject)
+	const FWeaponDataTable* WeaponDataRow = FindWeaponData();
+	if (WeaponDataRow)
 	{
-		FWeaponDataTable* WeaponDataRow = nullptr;
-		switch (WeaponType)
-		{
-		case EWeaponType::EWT_SubmachineGun:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("SubmachineGun"), TEXT(""));
-			break;
-		case EWeaponType::EWT_AssaultRifle:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("AssaultRifle"), TEXT(""));
-			break;
-		case EWeaponType::EWT_Pistol:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("Pistol"), TEXT(""));
-			break;
-		}
+		WeaponData = *WeaponDataRow;
+		AmmoType = WeaponDataRow->AmmoType;
+		Ammo = WeaponDataRow->WeaponAmmo;
+		MagazineCapacity = WeaponDataRow->MagazineCapacity;
+		// the mesh, material and anim BP are needed as soon as the weapon is in the world
+		GetItemMesh()->SetSkeletalMesh(WeaponDataRow->ItemMesh.LoadSynchronous());
+		SetItemName(WeaponDataRow->ItemName);
 
-		if (WeaponDataRow)
-		{
-			AmmoType = WeaponDataRow->AmmoType;
-			Ammo = WeaponDataRow->WeaponAmmo;
-			MagazineCapacity = WeaponDataRow->MagazineCapacity;
-			SetPickupSound(WeaponDataRow->PickupSound);
-			SetEquippedSound(WeaponDataRow->EquipSound);
-			GetItemMesh()->SetSkeletalMesh(WeaponDataRow->ItemMesh);
-			SetItemName(WeaponDataRow->ItemName);
-			SetIconItem(WeaponDataRow->InventoryIcon);
-			SetAmmoIcon(WeaponDataRow->AmmoIcon);
-
-			SetMaterialInstance(WeaponDataRow->MaterialInstance);
-			PreviousMaterialIndex = GetMaterialIndex();
-			GetItemMesh()->SetMaterial(PreviousMaterialIndex, nullptr);
-			SetMaterialIndex(WeaponDataRow->MaterialIndex);
-			SetClipBoneName(WeaponDataRow->ClipBoneName);
-			SetReloadMontageSection(WeaponDataRow->ReloadMontageSection);
-			GetItemMesh()->SetAnimInstanceClass(WeaponDataRow->AnimBP);
-			CrosshairsMiddle = WeaponDataRow->CrosshairsMiddle;
-			CrosshairsLeft = WeaponDataRow->CrosshairsLeft;
-			CrosshairsRight = WeaponDataRow->CrosshairsRight;
-			CrosshairsBottom = WeaponDataRow->CrosshairsBottom;
-			CrosshairsTop = WeaponDataRow->CrosshairsTop;
-			AutoFireRate = WeaponDataRow->AutoFireRate;
-			MuzzleFlash = WeaponDataRow->MuzzleFlash;
-			FireSound = WeaponDataRow->FireSound;
-			BoneToHide = WeaponDataRow->BoneToHide;
-			bAutomatic = WeaponDataRow->bAutomatic;
-			Damage = WeaponDataRow->Damage;
-			HeadShotDamage = WeaponDataRow->HeadshotDamage;
+		SetMaterialInstance(WeaponDataRow->MaterialInstance.LoadSynchronous());
+		PreviousMaterialIndex = GetMaterialIndex();
+		GetItemMesh()->SetMaterial(PreviousMaterialIndex, nullptr);
+		SetMaterialIndex(WeaponDataRow->MaterialIndex);
+		SetClipBoneName(WeaponDataRow->ClipBoneName);
+		SetReloadMontageSection(WeaponDataRow->ReloadMontageSection);
+		GetItemMesh()->SetAnimInstanceClass(WeaponDataRow->AnimBP.LoadSynchronous());
+		AutoFireRate = WeaponDataRow->AutoFireRate;
+		BoneToHide = WeaponDataRow->BoneToHide;
+		bAutomatic = WeaponDataRow->bAutomatic;
+		Damage = WeaponDataRow->Damage;
+		HeadShotDamage = WeaponDataRow->HeadshotDamage;
+		bProjectile = WeaponDataRow->bProjectile;
+		MuzzleVelocity = WeaponDataRow->MuzzleVelocity;
+		BulletGravityScale = WeaponDataRow->BulletGravityScale;
+		BulletDrag = WeaponDataRow->BulletDrag;
 
-		}
+		// everything else is streamed in once the player gets close
+		SetStreamedAssetsLoaded(false);
+	}
 
-		if (GetMaterialInstance())
+	if (GetMaterialInstance())
+	{
+		SetDynamicMaterialInstance(UMaterialInstanceDynamic::Create(GetMaterialInstance(), this));
+		GetDynamicMaterialInstance()->SetVectorParameterValue(TEXT("FresnelColor"), GetGlowColor());
+		GetItemMesh()->SetMaterial(GetMaterialIndex(), GetDynamicMaterialInstance());
+		EnableGlowMaterial();
+	}
+}
+
+const FWeaponDataTable* AWeapon::FindWeaponData()
+{
+	if (WeaponId != INDEX_NONE && GEngine)
+	{
+		UWeaponRegistry* Registry = GEngine->GetEngineSubsystem<UWeaponRegistry>();
+		const UWeaponDefinition* Definition = Registry ? Registry->FindDefinition(WeaponId) : nullptr;
+		if (Definition)
 		{
-			SetDynamicMaterialInstance(UMaterialInstanceDynamic::Create(GetMaterialInstance(), this));
-			GetDynamicMaterialInstance()->SetVectorParameterValue(TEXT("FresnelColor"), GetGlowColor());
-			GetItemMesh()->SetMaterial(GetMaterialIndex(), GetDynamicMaterialInstance());
-			EnableGlowMaterial();
+			WeaponType = Definition->WeaponType;
+			WeaponDataRowName = Definition->GetFName();
+			return &Definition->Data;
 		}
 	}
+
+	// fall back to the data table row for the weapon type
+	const FString WeaponTablePath{ TEXT("/Script/Engine.DataTable'/Game/_Game/DataTables/WeaponDataTable.WeaponDataTable'") };
+	UDataTable* WeaponTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *WeaponTablePath));
+	if (WeaponTableObject == nullptr) return nullptr;
+
+	switch (WeaponType)
+	{
+	case EWeaponType::EWT_SubmachineGun:
+		WeaponDataRowName = FName("SubmachineGun");
+		break;
+	case EWeaponType::EWT_AssaultRifle:
+		WeaponDataRowName = FName("AssaultRifle");
+		break;
+	case EWeaponType::EWT_Pistol:
+		WeaponDataRowName = FName("Pistol");
+		break;
+	}
+	return WeaponTableObject->FindRow<FWeaponDataTable>(WeaponDataRowName, TEXT(""));
 }
 
 void AWeapon::BeginPlay()
@@ -139,6 +210,125 @@ void AWeapon::BeginPlay()
 	{
 		GetItemMesh()->HideBoneByName(BoneToHide, EPhysBodyOp::PBO_None);
 	}
+
+	SlideDisplacementTable = UCurveBakeSubsystem::Bake(this, SlideDisplacementCurve);
+
+	GetAreaSphere()->OnComponentBeginOverlap.AddDynamic(this, &AWeapon::AssetRangeOverlap);
+	GetAreaSphere()->OnComponentEndOverlap.AddDynamic(this, &AWeapon::AssetRangeEndOverlap);
+
+	GetItemMesh()->OnComponentSleep.AddDynamic(this, &AWeapon::OnMeshSleep);
+}
+
+void AWeapon::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	bPlayerInAssetRange = false;
+	if (bStreamedAssetsInUse)
+	{
+		if (UWeaponAssetStreamer* Streamer = GetWorld()->GetSubsystem<UWeaponAssetStreamer>())
+		{
+			Streamer->ReleaseAssets(this);
+		}
+		bStreamedAssetsInUse = false;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AWeapon::SetItemProperties(EItemState State)
+{
+	Super::SetItemProperties(State);
+
+	UpdateStreamedAssetUse();
+}
+
+void AWeapon::AssetRangeOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	if (Cast<AShooterCharacter>(OtherActor))
+	{
+		bPlayerInAssetRange = true;
+		UpdateStreamedAssetUse();
+	}
+}
+
+void AWeapon::AssetRangeEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+{
+	if (Cast<AShooterCharacter>(OtherActor))
+	{
+		bPlayerInAssetRange = false;
+		UpdateStreamedAssetUse();
+	}
+}
+
+void AWeapon::UpdateStreamedAssetUse()
+{
+	UWorld* World = GetWorld();
+	UWeaponAssetStreamer* Streamer = World ? World->GetSubsystem<UWeaponAssetStreamer>() : nullptr;
+	if (Streamer == nullptr || WeaponDataRowName.IsNone()) return;
+
+	const EItemState State{ GetItemState() };
+	const bool bHeld{
+		State == EItemState::EIS_EquipInterping ||
+		State == EItemState::EIS_PickedUp ||
+		State == EItemState::EIS_Equipped };
+
+	if (bHeld || bPlayerInAssetRange)
+	{
+		if (!bStreamedAssetsInUse)
+		{
+			bStreamedAssetsInUse = true;
+			Streamer->AcquireAssets(this);
+		}
+		if (bHeld)
+		{
+			// a held weapon can fire right away, so it can't wait for the async load
+			Streamer->WaitForAssets(this);
+		}
+	}
+	else if (bStreamedAssetsInUse)
+	{
+		bStreamedAssetsInUse = false;
+		Streamer->ReleaseAssets(this);
+	}
+}
+
+void AWeapon::GetStreamedAssetPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	const TSoftObjectPtr<UObject> Assets[]{
+		WeaponData.PickupSound,
+		WeaponData.EquipSound,
+		WeaponData.InventoryIcon,
+		WeaponData.AmmoIcon,
+		WeaponData.CrosshairsMiddle,
+		WeaponData.CrosshairsLeft,
+		WeaponData.CrosshairsRight,
+		WeaponData.CrosshairsBottom,
+		WeaponData.CrosshairsTop,
+		WeaponData.MuzzleFlash,
+		WeaponData.FireSound };
+
+	for (const TSoftObjectPtr<UObject>& Asset : Assets)
+	{
+		if (!Asset.IsNull())
+		{
+			OutPaths.Add(Asset.ToSoftObjectPath());
+		}
+	}
+}
+
+void AWeapon::SetStreamedAssetsLoaded(bool bLoaded)
+{
+	// Get() is only non-null while the streamer's handle keeps the asset in memory
+	SetPickupSound(bLoaded ? WeaponData.PickupSound.Get() : nullptr);
+	SetEquippedSound(bLoaded ? WeaponData.EquipSound.Get() : nullptr);
+	SetIconItem(bLoaded ? WeaponData.InventoryIcon.Get() : nullptr);
+	SetAmmoIcon(bLoaded ? WeaponData.AmmoIcon.Get() : nullptr);
+	CrosshairsMiddle = bLoaded ? WeaponData.CrosshairsMiddle.Get() : nullptr;
+	CrosshairsLeft = bLoaded ? WeaponData.CrosshairsLeft.Get() : nullptr;
+	CrosshairsRight = bLoaded ? WeaponData.CrosshairsRight.Get() : nullptr;
+	CrosshairsBottom = bLoaded ? WeaponData.CrosshairsBottom.Get() : nullptr;
+	CrosshairsTop = bLoaded ? WeaponData.CrosshairsTop.Get() : nullptr;
+	MuzzleFlash = bLoaded ? WeaponData.MuzzleFlash.Get() : nullptr;
+	FireSound = bLoaded ? WeaponData.FireSound.Get() : nullptr;
 }
 
 void AWeapon::FinishMovingSlide()
@@ -148,10 +338,10 @@ void AWeapon::FinishMovingSlide()
 
 void AWeapon::UpdateSlideDisplacement()
 {
-	if (SlideDisplacementCurve && bMovingSlide)
+	if (SlideDisplacementTable && bMovingSlide)
 	{
 		const float ElapsedTime{ GetWorldTimerManager().GetTimerElapsed(SlideTimer) };
-		const float CurveValue{ SlideDisplacementCurve->GetFloatValue(ElapsedTime) };
+		const float CurveValue{ SlideDisplacementTable->Evaluate(ElapsedTime) };
 		SlideDisplacement = CurveValue * MaxSlideDisplacement;
 		RecoilRotation = CurveValue * MaxRecoilRotation;
 	}
@@ -26,28 +26,25 @@ struct FWeaponDataTable : public FTableRowBase
 	int32 MagazineCapacity;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	class USoundCue* PickupSound;
+	TSoftObjectPtr<class USoundCue> PickupSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USoundCue* EquipSound;
+	TSoftObjectPtr<USoundCue> EquipSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	class UWidgetComponent* PickupWidget;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USkeletalMesh* ItemMesh;
+	TSoftObjectPtr<USkeletalMesh> ItemMesh;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FString ItemName;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* InventoryIcon;
+	TSoftObjectPtr<UTexture2D> InventoryIcon;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* AmmoIcon;
+	TSoftObjectPtr<UTexture2D> AmmoIcon;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UMaterialInstance* MaterialInstance;
+	TSoftObjectPtr<UMaterialInstance> MaterialInstance;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int32 MaterialIndex;
@@ -59,31 +56,31 @@ struct FWeaponDataTable : public FTableRowBase
 	FName ReloadMontageSection;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TSubclassOf<UAnimInstance> AnimBP;
+	TSoftClassPtr<UAnimInstance> AnimBP;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* CrosshairsMiddle;
+	TSoftObjectPtr<UTexture2D> CrosshairsMiddle;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-		UTexture2D* CrosshairsLeft;
+		TSoftObjectPtr<UTexture2D> CrosshairsLeft;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-		UTexture2D* CrosshairsRight;
+		TSoftObjectPtr<UTexture2D> CrosshairsRight;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-		UTexture2D* CrosshairsBottom;
+		TSoftObjectPtr<UTexture2D> CrosshairsBottom;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-		UTexture2D* CrosshairsTop;
+		TSoftObjectPtr<UTexture2D> CrosshairsTop;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float AutoFireRate;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UParticleSystem* MuzzleFlash;
+	TSoftObjectPtr<UParticleSystem> MuzzleFlash;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USoundCue* FireSound;
+	TSoftObjectPtr<USoundCue> FireSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FName BoneToHide;
@@ -96,6 +93,18 @@ struct FWeaponDataTable : public FTableRowBase
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float HeadshotDamage;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bProjectile = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MuzzleVelocity = 40'000.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float BulletGravityScale = 1.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float BulletDrag = 0.f;
 };
 
 
@@ -116,17 +125,51 @@ protected:
 
 	void StopFalling();
 
+	// Called when the thrown mesh comes to rest
+	UFUNCTION()
+	void OnMeshSleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
+	// Lock roll and pitch in the physics body while the weapon falls
+	void SetUprightLock(bool bLock);
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void SetItemProperties(EItemState State) override;
 
 	void FinishMovingSlide();
 
+	UFUNCTION()
+	void AssetRangeOverlap(
+		UPrimitiveComponent* OverlappedComponent,
+		AActor* OtherActor,
+		UPrimitiveComponent* OtherComp,
+		int32 OtherBodyIndex,
+		bool bFromSweep,
+		const FHitResult& SweepResult);
+
+	UFUNCTION()
+	void AssetRangeEndOverlap(
+		UPrimitiveComponent* OverlappedComponent,
+		AActor* OtherActor,
+		UPrimitiveComponent* OtherComp,
+		int32 OtherBodyIndex);
+
+	// Weapon data from the definition asset for WeaponId, or from the data table row for WeaponType
+	const FWeaponDataTable* FindWeaponData();
+
+	// Acquire or release streamed assets when the player's range or the held state changes
+	void UpdateStreamedAssetUse();
+
 	void UpdateSlideDisplacement();
 
 private:
 
 	FTimerHandle ThrowWeaponTimer;
+
+	// longest a thrown weapon can take to settle before it returns to pickup anyway
 	float ThrowWeaponTime;
 	bool bFalling;
 
@@ -142,6 +185,10 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
 	EWeaponType WeaponType;
 
+	// ID of the weapon definition asset to build from, -1 to use the WeaponType row of the data table
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true", ClampMin = "-1"))
+	int32 WeaponId;
+
 	// Type of ammo for this weapon
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
 	EAmmoType AmmoType;
@@ -162,6 +209,19 @@ private:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "DataTable", meta = (AllowPrivateAccess = "true"))
 	UDataTable* WeaponDataTable;
 
+	// data this weapon was built from, its soft references are streamed in on demand
+	UPROPERTY()
+	FWeaponDataTable WeaponData;
+
+	// name of the definition asset or data table row WeaponData came from
+	FName WeaponDataRowName;
+
+	// true while the player is inside the area sphere
+	bool bPlayerInAssetRange;
+
+	// true while this weapon holds a use on its streamed assets
+	bool bStreamedAssetsInUse;
+
 	int32 PreviousMaterialIndex;
 
 	// Textures for the weapon crosshairs
@@ -201,6 +261,9 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Pistol, meta = (AllowPrivateAccess = "true"))
 	UCurveFloat* SlideDisplacementCurve;
 
+	// SlideDisplacementCurve baked in BeginPlay
+	TSharedPtr<const FBakedCurve> SlideDisplacementTable;
+
 	// timer handle for updating slide displacement
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Pistol, meta = (AllowPrivateAccess = "true"))
 	FTimerHandle SlideTimer;
@@ -236,12 +299,32 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
 	float HeadShotDamage;
 
+	// true to fire simulated bullets instead of hitscan
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties|Projectile", meta = (AllowPrivateAccess = "true"))
+	bool bProjectile;
+
+	// speed of a simulated bullet when it leaves the barrel
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties|Projectile", meta = (AllowPrivateAccess = "true"))
+	float MuzzleVelocity;
+
+	// scale applied to world gravity for bullet drop
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties|Projectile", meta = (AllowPrivateAccess = "true"))
+	float BulletGravityScale;
+
+	// quadratic air drag applied to simulated bullets
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties|Projectile", meta = (AllowPrivateAccess = "true"))
+	float BulletDrag;
+
 
 public:
 
 	// Adds an impulse to the weapon
 	void ThrowWeapon();
 
+	virtual void SaveSnapshot(FItemSnapshot& OutSnapshot) const override;
+	virtual void LoadSnapshotDefaults(const FItemSnapshot& Snapshot) override;
+	virtual void LoadSnapshot(const FItemSnapshot& Snapshot) override;
+
 	FORCEINLINE int32 GetAmmo() const { return Ammo; }
 	FORCEINLINE int32 GetMagazineCapacity() const { return MagazineCapacity; }
 
@@ -267,11 +350,27 @@ public:
 	FORCEINLINE float GetDamage() const { return Damage; }
 	FORCEINLINE float GetHeadshotDamage() const { return HeadShotDamage; }
 
+	FORCEINLINE bool IsProjectile() const { return bProjectile; }
+	FORCEINLINE float GetMuzzleVelocity() const { return MuzzleVelocity; }
+	FORCEINLINE float GetBulletGravityScale() const { return BulletGravityScale; }
+	FORCEINLINE float GetBulletDrag() const { return BulletDrag; }
+
 	void ReloadAmmo(int32 Amount);
 
 	FORCEINLINE void SetMovingClip(bool Move) { bMovingClip = Move; }
 
 	void StartSlideTimer();
 
+	FORCEINLINE int32 GetWeaponId() const { return WeaponId; }
+
+	// Unique per weapon definition or data table row
+	FORCEINLINE FName GetWeaponDataRowName() const { return WeaponDataRowName; }
+
+	// Soft references that are only loaded while the weapon is near the player or held
+	void GetStreamedAssetPaths(TArray<FSoftObjectPath>& OutPaths) const;
+
+	// Point at the streamed assets once loaded, or drop them so they can be freed
+	void SetStreamedAssetsLoaded(bool bLoaded);
+
 	bool ClipIsFull();
 };
\ No newline at end of file
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponAssetStreamer.h"
+#include "Engine/AssetManager.h"
+#include "Weapon.h"
+#include "Shooter.h"
+#include "ShooterTimings.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Streamed Weapon Types"), STAT_StreamedWeaponTypes, STATGROUP_Shooter);
+
+UWeaponAssetStreamer::UWeaponAssetStreamer() :
+	UnusedReleaseDelay(30.f)
+{
+}
+
+void UWeaponAssetStreamer::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SHOOTER_SCOPE_TIMING(AssetStreaming);
+
+	const float Now{ GetWorld()->GetTimeSeconds() };
+	for (auto It = WeaponTypes.CreateIterator(); It; ++It)
+	{
+		FStreamedWeaponType& WeaponType{ It.Value() };
+		if (WeaponType.NumInUse > 0 || Now - WeaponType.UnusedSince < UnusedReleaseDelay) continue;
+
+		// drop the weapons' hard references first, or the handle release won't free anything
+		for (const TWeakObjectPtr<AWeapon>& Weapon : WeaponType.Weapons)
+		{
+			if (Weapon.IsValid())
+			{
+				Weapon->SetStreamedAssetsLoaded(false);
+			}
+		}
+		if (WeaponType.Handle.IsValid())
+		{
+			WeaponType.Handle->ReleaseHandle();
+		}
+		It.RemoveCurrent();
+	}
+	SET_DWORD_STAT(STAT_StreamedWeaponTypes, WeaponTypes.Num());
+}
+
+TStatId UWeaponAssetStreamer::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UWeaponAssetStreamer, STATGROUP_Tickables);
+}
+
+bool UWeaponAssetStreamer::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UWeaponAssetStreamer::AcquireAssets(AWeapon* Weapon)
+{
+	if (Weapon == nullptr) return;
+
+	const FName WeaponKey{ Weapon->GetWeaponDataRowName() };
+	FStreamedWeaponType& WeaponType{ WeaponTypes.FindOrAdd(WeaponKey) };
+	WeaponType.NumInUse++;
+	WeaponType.Weapons.AddUnique(Weapon);
+
+	if (!WeaponType.Handle.IsValid())
+	{
+		TArray<FSoftObjectPath> AssetPaths;
+		Weapon->GetStreamedAssetPaths(AssetPaths);
+
+		// may complete (and call OnAssetsLoaded) right away if everything is already in memory
+		WeaponType.Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+			AssetPaths,
+			FStreamableDelegate::CreateUObject(this, &UWeaponAssetStreamer::OnAssetsLoaded, WeaponKey));
+	}
+	else if (WeaponType.Handle->HasLoadCompleted())
+	{
+		Weapon->SetStreamedAssetsLoaded(true);
+	}
+}
+
+void UWeaponAssetStreamer::WaitForAssets(AWeapon* Weapon)
+{
+	if (Weapon == nullptr) return;
+
+	const FName WeaponKey{ Weapon->GetWeaponDataRowName() };
+	FStreamedWeaponType* WeaponType{ WeaponTypes.Find(WeaponKey) };
+	if (WeaponType == nullptr || !WeaponType->Handle.IsValid() || WeaponType->Handle->HasLoadCompleted()) return;
+
+	WeaponType->Handle->WaitUntilComplete();
+	OnAssetsLoaded(WeaponKey);
+}
+
+void UWeaponAssetStreamer::ReleaseAssets(AWeapon* Weapon)
+{
+	if (Weapon == nullptr) return;
+
+	FStreamedWeaponType* WeaponType{ WeaponTypes.Find(Weapon->GetWeaponDataRowName()) };
+	if (WeaponType == nullptr || WeaponType->NumInUse == 0) return;
+
+	WeaponType->NumInUse--;
+	if (WeaponType->NumInUse == 0)
+	{
+		WeaponType->UnusedSince = GetWorld()->GetTimeSeconds();
+	}
+}
+
+void UWeaponAssetStreamer::OnAssetsLoaded(FName WeaponKey)
+{
+	FStreamedWeaponType* WeaponType{ WeaponTypes.Find(WeaponKey) };
+	if (WeaponType == nullptr) return;
+
+	for (const TWeakObjectPtr<AWeapon>& Weapon : WeaponType->Weapons)
+	{
+		if (Weapon.IsValid())
+		{
+			Weapon->SetStreamedAssetsLoaded(true);
+		}
+	}
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "WeaponAssetStreamer.generated.h"
+
+class AWeapon;
+
+// Streamed assets shared by every weapon of one type
+struct FStreamedWeaponType
+{
+	TSharedPtr<FStreamableHandle> Handle;
+
+	// weapons of this type that are handed the assets once they're loaded
+	TArray<TWeakObjectPtr<AWeapon>> Weapons;
+
+	// weapons of this type near the player or held right now
+	int32 NumInUse{ 0 };
+
+	// when NumInUse last dropped to zero
+	float UnusedSince{ 0.f };
+};
+
+/**
+ * Loads the sounds, icons, crosshairs and muzzle flash of a weapon type on demand.
+ * A weapon acquires its assets when the player walks into its pickup radius or holds it,
+ * and the assets are released once no weapon of that type has been used for a while.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UWeaponAssetStreamer : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponAssetStreamer();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Start streaming a weapon's assets
+	void AcquireAssets(AWeapon* Weapon);
+
+	// Block until an acquired weapon's assets are in memory
+	void WaitForAssets(AWeapon* Weapon);
+
+	// The weapon no longer needs its assets, they're released after UnusedReleaseDelay
+	void ReleaseAssets(AWeapon* Weapon);
+
+private:
+
+	// Hand the loaded assets to every weapon of a type
+	void OnAssetsLoaded(FName WeaponKey);
+
+	// Seconds a weapon type stays resident after its last use
+	UPROPERTY(Config)
+	float UnusedReleaseDelay;
+
+	// keyed by weapon data table row
+	TMap<FName, FStreamedWeaponType> WeaponTypes;
+};
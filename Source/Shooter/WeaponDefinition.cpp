@@ -0,0 +1,11 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponDefinition.h"
+
+const FPrimaryAssetType UWeaponDefinition::PrimaryAssetType{ TEXT("WeaponDefinition") };
+
+FPrimaryAssetId UWeaponDefinition::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Weapon.h"
+#include "WeaponDefinition.generated.h"
+
+/**
+ * One weapon, authored as content. Every definition in the WeaponDefinition primary asset
+ * directories is picked up at startup, so new weapons don't need code or enum changes.
+ */
+UCLASS(BlueprintType)
+class SHOOTER_API UWeaponDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	// Stable ID, saved in levels and save games, never reuse one
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (ClampMin = "0"))
+	int32 WeaponId{ INDEX_NONE };
+
+	// Animation and recoil family the weapon belongs to
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	EWeaponType WeaponType{ EWeaponType::EWT_SubmachineGun };
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	FWeaponDataTable Data;
+};
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponRegistry.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/AssetManager.h"
+#include "WeaponDefinition.h"
+
+UWeaponRegistry::UWeaponRegistry() :
+	MaxWeaponId(1023),
+	bBuilt(false)
+{
+}
+
+void UWeaponRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	IAssetRegistry* AssetRegistry{ IAssetRegistry::Get() };
+	if (AssetRegistry && AssetRegistry->IsLoadingAssets())
+	{
+		FilesLoadedHandle = AssetRegistry->OnFilesLoaded().AddUObject(this, &UWeaponRegistry::OnAssetRegistryFilesLoaded);
+	}
+}
+
+void UWeaponRegistry::Deinitialize()
+{
+	if (IAssetRegistry* AssetRegistry = IAssetRegistry::Get())
+	{
+		AssetRegistry->OnFilesLoaded().Remove(FilesLoadedHandle);
+	}
+	FilesLoadedHandle.Reset();
+
+	Super::Deinitialize();
+}
+
+void UWeaponRegistry::OnAssetRegistryFilesLoaded()
+{
+	// the asset manager refreshes its own asset list from the same event, so don't rebuild until the next lookup
+	bBuilt = false;
+}
+
+const UWeaponDefinition* UWeaponRegistry::FindDefinition(int32 WeaponId)
+{
+	if (!bBuilt)
+	{
+		Rebuild();
+	}
+	return DefinitionsById.IsValidIndex(WeaponId) ? DefinitionsById[WeaponId].Get() : nullptr;
+}
+
+void UWeaponRegistry::Rebuild()
+{
+	DefinitionsById.Reset();
+
+	// the asset manager isn't up yet during early engine init, try again on the next lookup
+	if (!UAssetManager::IsValid()) return;
+
+	// while the editor is still scanning, use what's known so far and rebuild on a later lookup
+	const IAssetRegistry* AssetRegistry{ IAssetRegistry::Get() };
+	bBuilt = AssetRegistry == nullptr || !AssetRegistry->IsLoadingAssets();
+
+	UAssetManager& AssetManager{ UAssetManager::Get() };
+	TArray<FPrimaryAssetId> AssetIds;
+	AssetManager.GetPrimaryAssetIdList(UWeaponDefinition::PrimaryAssetType, AssetIds);
+
+	// definitions only hold soft references, so loading all of them up front is cheap
+	for (const FPrimaryAssetId& AssetId : AssetIds)
+	{
+		UWeaponDefinition* Definition = Cast<UWeaponDefinition>(AssetManager.GetPrimaryAssetPath(AssetId).TryLoad());
+		if (Definition == nullptr) continue;
+
+		const int32 WeaponId{ Definition->WeaponId };
+		if (WeaponId < 0 || WeaponId > MaxWeaponId)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Weapon definition %s has invalid ID %d"), *Definition->GetName(), WeaponId);
+			continue;
+		}
+		if (DefinitionsById.IsValidIndex(WeaponId) && DefinitionsById[WeaponId])
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Weapon definitions %s and %s share ID %d"),
+				*DefinitionsById[WeaponId]->GetName(), *Definition->GetName(), WeaponId);
+			continue;
+		}
+
+		if (WeaponId >= DefinitionsById.Num())
+		{
+			DefinitionsById.SetNumZeroed(WeaponId + 1);
+		}
+		DefinitionsById[WeaponId] = Definition;
+	}
+}
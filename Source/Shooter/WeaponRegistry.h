@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "WeaponRegistry.generated.h"
+
+class UWeaponDefinition;
+
+/**
+ * Every weapon definition, in a flat array indexed by weapon ID.
+ * An engine subsystem so weapons can resolve their definition in OnConstruction in the editor too.
+ * Built on lookup from the Asset Manager, which finds definitions through the WeaponDefinition
+ * primary asset type in DefaultGame.ini (that also gets them cooked). In the editor the table is
+ * rebuilt once the asset registry has finished its initial scan.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UWeaponRegistry : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponRegistry();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// O(1) lookup, null for unknown IDs
+	const UWeaponDefinition* FindDefinition(int32 WeaponId);
+
+	// Reload every definition the Asset Manager knows about, e.g. after adding one in the editor
+	void Rebuild();
+
+private:
+
+	// the asset registry finished scanning, the next lookup rebuilds
+	void OnAssetRegistryFilesLoaded();
+
+	// IDs above this are rejected so a typo can't allocate a huge table
+	UPROPERTY(Config)
+	int32 MaxWeaponId;
+
+	// indexed by WeaponId, null where no definition uses the ID
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UWeaponDefinition>> DefinitionsById;
+
+	// false until a build saw the complete asset registry
+	bool bBuilt;
+
+	FDelegateHandle FilesLoadedHandle;
+};